@@ -0,0 +1,141 @@
+#include "dumb_cycle.h"
+
+enum band_limits {
+    BAND_MAX_WORKERS = 64,
+    BAND_STACK_SIZE = 64 * 1024,
+};
+
+struct band_worker {
+    struct band_pool *pool;
+    i32 id;
+    u32 *scanline;
+    struct thread thread;
+};
+
+static void band_draw(struct band_pool *pool, struct band_worker *worker) {
+    u32 height = (u32)pool->state->height;
+    u32 bands = (u32)pool->workers_len;
+    u32 id = (u32)worker->id;
+    draw_game_rows(
+        pool->renderer,
+        pool->buf,
+        pool->state,
+        worker->scanline,
+        height * id / bands,
+        height * (id + 1) / bands
+    );
+    u32 done = __atomic_add_fetch(&pool->done, 1, __ATOMIC_ACQ_REL);
+    if (done == (u32)pool->workers_len) {
+        futex_wake(&pool->done, 1);
+    }
+}
+
+static void band_worker_main(void *arg) {
+    struct band_worker *worker = arg;
+    struct band_pool *pool = worker->pool;
+    u32 seen = 0;
+    while (1) {
+        u32 generation = __atomic_load_n(&pool->generation, __ATOMIC_ACQUIRE);
+        while (generation == seen) {
+            futex_wait(&pool->generation, generation);
+            generation = __atomic_load_n(&pool->generation, __ATOMIC_ACQUIRE);
+        }
+        seen = generation;
+        if (__atomic_load_n(&pool->quit, __ATOMIC_ACQUIRE)) {
+            return;
+        }
+        band_draw(pool, worker);
+    }
+}
+
+i32 band_pool_init(
+    struct band_pool *pool,
+    struct arena *arena,
+    struct renderer *renderer,
+    i32 workers_len
+) {
+    if (workers_len < 1) {
+        workers_len = 1;
+    }
+    if (workers_len > BAND_MAX_WORKERS) {
+        workers_len = BAND_MAX_WORKERS;
+    }
+
+    pool->renderer = renderer;
+    pool->workers_len = workers_len;
+    pool->generation = 0;
+    pool->done = 0;
+    pool->quit = 0;
+    pool->workers = alloc(arena, workers_len * (i64)sizeof(*pool->workers));
+    if (pool->workers == 0) {
+        return -1;
+    }
+
+    for (i32 i = 0; i < workers_len; ++i) {
+        struct band_worker *worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->id = i;
+        worker->scanline = renderer->scanline;
+        if (i == 0) {
+            continue;
+        }
+        if (renderer->mode != RENDER_MODE_SPAN) {
+            worker->scanline = alloc(
+                arena,
+                renderer->scanline_words * sizeof(u32)
+            );
+            if (worker->scanline == 0) {
+                pool->workers_len = i;
+                return -1;
+            }
+        }
+        char *stack = alloc(arena, BAND_STACK_SIZE);
+        if (stack == 0) {
+            pool->workers_len = i;
+            return -1;
+        }
+        i32 error = thread_create(
+            &worker->thread,
+            stack,
+            BAND_STACK_SIZE,
+            band_worker_main,
+            worker
+        );
+        if (error != 0) {
+            pool->workers_len = i;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void band_pool_stop(struct band_pool *pool) {
+    __atomic_store_n(&pool->quit, 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&pool->generation, 1, __ATOMIC_RELEASE);
+    futex_wake(&pool->generation, pool->workers_len);
+    for (i32 i = 1; i < pool->workers_len; ++i) {
+        thread_join(&pool->workers[i].thread);
+    }
+    pool->workers_len = 1;
+}
+
+void band_pool_draw(
+    struct band_pool *pool,
+    struct drm_mode_dumb_buffer *buf,
+    struct game_state *state
+) {
+    pool->buf = buf;
+    pool->state = state;
+    __atomic_store_n(&pool->done, 0, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&pool->generation, 1, __ATOMIC_RELEASE);
+    if (pool->workers_len > 1) {
+        futex_wake(&pool->generation, pool->workers_len - 1);
+    }
+    band_draw(pool, &pool->workers[0]);
+    u32 done = __atomic_load_n(&pool->done, __ATOMIC_ACQUIRE);
+    while (done != (u32)pool->workers_len) {
+        futex_wait(&pool->done, done);
+        done = __atomic_load_n(&pool->done, __ATOMIC_ACQUIRE);
+    }
+}
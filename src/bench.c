@@ -0,0 +1,1508 @@
+#include "dumb_cycle.h"
+
+enum bench_error {
+    BENCH_ERROR_NONE = 0,
+    BENCH_ERROR_MMAP,
+    BENCH_ERROR_ALLOC,
+    BENCH_ERROR_CLOCK_GETTIME,
+    BENCH_ERROR_RENDERER_INIT,
+    BENCH_ERROR_FAKE_DRM,
+};
+
+struct bench {
+    struct arena arena;
+    struct print_buffer out;
+    char **filters;
+    i32 filters_len;
+    u64 rng;
+};
+
+static u32 random_u32(struct bench *bench) {
+    bench->rng = bench->rng * 6364136223846793005UL + 1442695040888963407UL;
+    return (u32)(bench->rng >> 33);
+}
+
+static i64 now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.sec * 1000L * 1000L * 1000L + now.nsec;
+}
+
+static i32 has_prefix(char *s, char *prefix) {
+    while (*prefix != 0) {
+        if (*s != *prefix) {
+            return 0;
+        }
+        s += 1;
+        prefix += 1;
+    }
+    return 1;
+}
+
+static i64 append_str(char *dst, i64 len, char *s) {
+    while (*s != 0) {
+        dst[len] = *s;
+        len += 1;
+        s += 1;
+    }
+    dst[len] = 0;
+    return len;
+}
+
+static i32 bench_enabled(struct bench *bench, char *group) {
+    if (bench->filters_len == 0) {
+        return 1;
+    }
+    for (i32 i = 0; i < bench->filters_len; ++i) {
+        if (has_prefix(group, bench->filters[i])) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void sort_u64(u64 *values, i64 len) {
+    i64 gap = 1;
+    while (gap < len / 3) {
+        gap = gap * 3 + 1;
+    }
+    while (gap > 0) {
+        for (i64 i = gap; i < len; ++i) {
+            u64 value = values[i];
+            i64 j = i;
+            while (j >= gap && values[j - gap] > value) {
+                values[j] = values[j - gap];
+                j -= gap;
+            }
+            values[j] = value;
+        }
+        gap /= 3;
+    }
+}
+
+static void report(
+    struct bench *bench,
+    char *name,
+    char *variant,
+    char *unit,
+    u64 *samples,
+    i64 samples_len
+) {
+    sort_u64(samples, samples_len);
+    i64 p99 = (samples_len * 99) / 100;
+    if (p99 >= samples_len) {
+        p99 = samples_len - 1;
+    }
+
+    struct print_buffer *out = &bench->out;
+    print_str(out, name);
+    if (variant != 0) {
+        print_char(out, '.');
+        print_str(out, variant);
+    }
+    print_char(out, '\t');
+    print_str(out, unit);
+    print_char(out, '\t');
+    print_i64(out, samples_len);
+    print_char(out, '\t');
+    print_u64(out, samples[0]);
+    print_char(out, '\t');
+    print_u64(out, samples[samples_len / 2]);
+    print_char(out, '\t');
+    print_u64(out, samples[p99]);
+    print_char(out, '\n');
+    print_flush(out);
+}
+
+static i32 cell_free(struct game_state *state, i32 x, i32 y) {
+    if (x < 0 || x >= state->width || y < 0 || y >= state->height) {
+        return 0;
+    }
+    return !board_test(board_row(state, y), x);
+}
+
+struct turn {
+    i32 vx;
+    i32 vy;
+};
+
+static i64 record_game(
+    struct bench *bench,
+    struct game_state *state,
+    struct turn *turns,
+    i64 turns_capacity
+) {
+    clear_game(state);
+    i64 ticks = 0;
+    while (!state->dead && ticks < turns_capacity) {
+        i32 x = state->x + state->vx;
+        i32 y = state->y + state->vy;
+        struct turn options[3] = {
+            { .vx = state->vx, .vy = state->vy },
+            { .vx = state->vy, .vy = -state->vx },
+            { .vx = -state->vy, .vy = state->vx },
+        };
+        i32 first = 0;
+        if (random_u32(bench) % 8 == 0) {
+            first = 1 + (i32)(random_u32(bench) % 2);
+        }
+        struct turn turn = options[first];
+        for (i32 i = 0; i < 3; ++i) {
+            struct turn option = options[(first + i) % 3];
+            if (cell_free(state, x + option.vx, y + option.vy)) {
+                turn = option;
+                break;
+            }
+        }
+
+        turns[ticks] = turn;
+        state->nvx = turn.vx;
+        state->nvy = turn.vy;
+        state->nnvx = turn.vx;
+        state->nnvy = turn.vy;
+        update_game(state);
+        ticks += 1;
+    }
+    return ticks;
+}
+
+static void replay_tick(struct game_state *state, struct turn *turn) {
+    state->nvx = turn->vx;
+    state->nvy = turn->vy;
+    state->nnvx = turn->vx;
+    state->nnvy = turn->vy;
+    update_game(state);
+}
+
+struct match_event {
+    i32 cycle;
+    struct turn turn;
+};
+
+static i32 record_match(
+    struct bench *bench,
+    struct match *match,
+    struct match_event *events,
+    i64 events_capacity,
+    i64 *tick_ends,
+    i32 ticks_capacity
+) {
+    match_reset(match);
+    i64 events_len = 0;
+    i32 ticks = 0;
+    while (match->alive_len > 0 && ticks < ticks_capacity) {
+        for (i32 i = 0; i < match->alive_len; ++i) {
+            i32 cycle = match->alive[i];
+            i32 vx = match->vx[cycle];
+            i32 vy = match->vy[cycle];
+            struct turn options[3] = {
+                { .vx = vx, .vy = vy },
+                { .vx = vy, .vy = -vx },
+                { .vx = -vy, .vy = vx },
+            };
+            i32 first = 0;
+            if (random_u32(bench) % 8 == 0) {
+                first = 1 + (i32)(random_u32(bench) % 2);
+            }
+            struct turn turn = options[first];
+            for (i32 j = 0; j < 3; ++j) {
+                struct turn option = options[(first + j) % 3];
+                i32 x = match->x[cycle] + vx + option.vx;
+                i32 y = match->y[cycle] + vy + option.vy;
+                if (match_cell_free(match, x, y)) {
+                    turn = option;
+                    break;
+                }
+            }
+            if (turn.vx == vx && turn.vy == vy) {
+                continue;
+            }
+            if (events_len == events_capacity) {
+                return ticks;
+            }
+            events[events_len].cycle = cycle;
+            events[events_len].turn = turn;
+            events_len += 1;
+            match_turn(match, cycle, turn.vx, turn.vy);
+        }
+        tick_ends[ticks] = events_len;
+        match_update(match);
+        ticks += 1;
+    }
+    return ticks;
+}
+
+struct board_size {
+    char *name;
+    i32 width;
+    i32 height;
+};
+
+static struct board_size board_sizes[] = {
+    { .name = "90x90", .width = 90, .height = 90 },
+    { .name = "160x90", .width = 160, .height = 90 },
+    { .name = "161x90", .width = 161, .height = 90 },
+};
+
+static struct game_state *bench_game_state(
+    struct arena *arena,
+    struct board_size *board
+) {
+    struct game_state *state = alloc(arena, sizeof(*state));
+    if (state == 0) {
+        return 0;
+    }
+    if (game_init(state, arena, board->width, board->height) != 0) {
+        return 0;
+    }
+    return state;
+}
+
+static i32 bench_game_board(struct bench *bench, struct board_size *board) {
+    struct arena arena = bench->arena;
+    struct game_state *state = bench_game_state(&arena, board);
+    i64 turns_capacity = board->width * board->height;
+    struct turn *turns = alloc(&arena, turns_capacity * (i64)sizeof(*turns));
+    i64 samples_len = 200;
+    u64 *samples = alloc(&arena, samples_len * (i64)sizeof(*samples));
+    u64 *rates = alloc(&arena, samples_len * (i64)sizeof(*rates));
+    if (state == 0 || turns == 0 || samples == 0 || rates == 0) {
+        return BENCH_ERROR_ALLOC;
+    }
+
+    i64 ticks = record_game(bench, state, turns, turns_capacity);
+
+    if (bench_enabled(bench, "update_game")) {
+        for (i64 i = 0; i < samples_len; ++i) {
+            clear_game(state);
+            i64 start = now_ns();
+            for (i64 j = 0; j < ticks; ++j) {
+                replay_tick(state, &turns[j]);
+            }
+            u64 elapsed = (u64)(now_ns() - start);
+            samples[i] = elapsed / (u64)ticks;
+            rates[i] = ((u64)ticks * 1000UL * 1000UL * 1000UL) / elapsed;
+        }
+        report(
+            bench,
+            "update_game",
+            board->name,
+            "ns/tick",
+            samples,
+            samples_len
+        );
+        report(
+            bench,
+            "update_game",
+            board->name,
+            "ticks/s",
+            rates,
+            samples_len
+        );
+    }
+
+    if (bench_enabled(bench, "clear_game")) {
+        i64 calls = 1000;
+        for (i64 i = 0; i < samples_len; ++i) {
+            i64 start = now_ns();
+            for (i64 j = 0; j < calls; ++j) {
+                clear_game(state);
+            }
+            samples[i] = (u64)(now_ns() - start) / (u64)calls;
+        }
+        report(
+            bench,
+            "clear_game",
+            board->name,
+            "ns/call",
+            samples,
+            samples_len
+        );
+    }
+
+    return BENCH_ERROR_NONE;
+}
+
+static i32 bench_game(struct bench *bench) {
+    for (u64 i = 0; i < sizeof(board_sizes) / sizeof(*board_sizes); ++i) {
+        i32 error = bench_game_board(bench, &board_sizes[i]);
+        if (error != BENCH_ERROR_NONE) {
+            return error;
+        }
+    }
+    return BENCH_ERROR_NONE;
+}
+
+struct resolution {
+    char *name;
+    u32 width;
+    u32 height;
+};
+
+static char *render_mode_names[] = {
+    [RENDER_MODE_SPAN] = "span",
+    [RENDER_MODE_STREAM] = "stream",
+    [RENDER_MODE_EXPAND] = "expand",
+};
+
+static char *pixel_format_names[] = {
+    [PIXEL_FORMAT_XRGB8888] = "",
+    [PIXEL_FORMAT_RGB565] = ".rgb565",
+};
+
+static i32 bench_render_resolution(
+    struct bench *bench,
+    struct resolution *resolution,
+    struct board_size *board
+) {
+    struct arena arena = bench->arena;
+    struct game_state *state = bench_game_state(&arena, board);
+    i64 turns_capacity = board->width * board->height;
+    struct turn *turns = alloc(&arena, turns_capacity * (i64)sizeof(*turns));
+    i64 samples_len = 100;
+    u64 *samples = alloc(&arena, turns_capacity * (i64)sizeof(*samples));
+    struct board_damage damage[3];
+    if (
+        state == 0 ||
+        turns == 0 ||
+        samples == 0 ||
+        board_damage_init(&damage[0], &arena, state) != 0 ||
+        board_damage_init(&damage[1], &arena, state) != 0 ||
+        board_damage_init(&damage[2], &arena, state) != 0
+    ) {
+        return BENCH_ERROR_ALLOC;
+    }
+
+    u32 stride = (resolution->width + 15) & ~15U;
+    u64 size = (u64)stride * resolution->height;
+    struct drm_mode_dumb_buffer bufs[3];
+    for (i32 i = 0; i < 3; ++i) {
+        bufs[i].width = resolution->width;
+        bufs[i].height = resolution->height;
+        bufs[i].stride = stride;
+        bufs[i].handle = (u32)i;
+        bufs[i].fb_id = (u32)i;
+        bufs[i].size = size;
+        bufs[i].map = mmap(
+            0,
+            (i64)(size * sizeof(u32)),
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS,
+            -1,
+            0
+        );
+        if (bufs[i].map == 0) {
+            return BENCH_ERROR_MMAP;
+        }
+    }
+
+    i64 ticks = record_game(bench, state, turns, turns_capacity);
+
+    char variant[64];
+    for (i32 pass = 0; pass < 2 * (RENDER_MODE_EXPAND + 1); ++pass) {
+        i32 mode = pass % (RENDER_MODE_EXPAND + 1);
+        i32 format = pass / (RENDER_MODE_EXPAND + 1);
+        struct arena mode_arena = arena;
+        struct renderer renderer;
+        i32 error = renderer_init(
+            &renderer,
+            &mode_arena,
+            (enum render_mode)mode,
+            (enum pixel_format)format,
+            resolution->width,
+            resolution->height,
+            state
+        );
+        if (error != 0) {
+            return BENCH_ERROR_RENDERER_INIT;
+        }
+        for (i32 j = 0; j < 3; ++j) {
+            bufs[j].stride = stride >> renderer.pixel_shift;
+        }
+
+        i64 len = append_str(variant, 0, render_mode_names[mode]);
+        len = append_str(variant, len, pixel_format_names[format]);
+        len = append_str(variant, len, ".");
+        len = append_str(variant, len, resolution->name);
+        len = append_str(variant, len, ".");
+        append_str(variant, len, board->name);
+
+        clear_game(state);
+        for (i64 j = 0; j < ticks / 2; ++j) {
+            replay_tick(state, &turns[j]);
+        }
+        for (i64 i = 0; i < samples_len; ++i) {
+            struct drm_mode_dumb_buffer *buf = &bufs[i & 1];
+            i64 start = now_ns();
+            draw_game(&renderer, buf, state);
+            draw_partial(&renderer, buf, state, renderer.scale / 2);
+            samples[i] = (u64)(now_ns() - start);
+        }
+        report(bench, "render.full", variant, "ns/frame", samples, samples_len);
+
+        damage[0].valid = 0;
+        damage[1].valid = 0;
+        clear_game(state);
+        for (i64 i = 0; i < ticks; ++i) {
+            struct drm_mode_dumb_buffer *buf = &bufs[i & 1];
+            replay_tick(state, &turns[i]);
+            i64 start = now_ns();
+            draw_damage(&renderer, buf, &damage[i & 1], state);
+            damage[i & 1].partial_cell = draw_partial(
+                &renderer,
+                buf,
+                state,
+                renderer.scale / 2
+            );
+            samples[i] = (u64)(now_ns() - start);
+        }
+        report(bench, "render.damage", variant, "ns/frame", samples, ticks);
+
+        struct drm_mode_dumb_buffer *shadow = &bufs[2];
+        for (i32 i = 0; i < 3; ++i) {
+            damage[i].valid = 0;
+            board_damage_submitted(&damage[i]);
+        }
+        clear_game(state);
+        for (i64 i = 0; i < ticks; ++i) {
+            struct drm_mode_dumb_buffer *buf = &bufs[i & 1];
+            replay_tick(state, &turns[i]);
+            i64 start = now_ns();
+            draw_damage(&renderer, shadow, &damage[2], state);
+            draw_partial_damage(
+                &renderer,
+                shadow,
+                &damage[2],
+                state,
+                renderer.scale / 2
+            );
+            board_damage_merge(&damage[0], &damage[2]);
+            board_damage_merge(&damage[1], &damage[2]);
+            board_damage_submitted(&damage[2]);
+            copy_damage(&renderer, buf, shadow, &damage[i & 1]);
+            board_damage_submitted(&damage[i & 1]);
+            samples[i] = (u64)(now_ns() - start);
+        }
+        report(bench, "render.shadow", variant, "ns/frame", samples, ticks);
+    }
+
+    for (i32 i = 0; i < 3; ++i) {
+        munmap(bufs[i].map, (i64)(size * sizeof(u32)));
+    }
+
+    return BENCH_ERROR_NONE;
+}
+
+static i32 bench_bands_board(
+    struct bench *bench,
+    struct resolution *resolution,
+    struct board_size *board
+) {
+    i32 thread_counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+    char *names[] = { "1", "2", "4", "8", "16", "32", "64" };
+
+    struct arena arena = bench->arena;
+    struct game_state *state = bench_game_state(&arena, board);
+    i64 turns_capacity = board->width * board->height;
+    struct turn *turns = alloc(&arena, turns_capacity * (i64)sizeof(*turns));
+    i64 samples_len = 100;
+    u64 *samples = alloc(&arena, samples_len * (i64)sizeof(*samples));
+    struct band_pool *pool = alloc(&arena, sizeof(*pool));
+    if (state == 0 || turns == 0 || samples == 0 || pool == 0) {
+        return BENCH_ERROR_ALLOC;
+    }
+
+    u32 stride = (resolution->width + 15) & ~15U;
+    u64 size = (u64)stride * resolution->height;
+    struct drm_mode_dumb_buffer buf;
+    buf.width = resolution->width;
+    buf.height = resolution->height;
+    buf.stride = stride;
+    buf.handle = 0;
+    buf.fb_id = 0;
+    buf.size = size;
+    buf.map = mmap(
+        0,
+        (i64)(size * sizeof(u32)),
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+    if (buf.map == 0) {
+        return BENCH_ERROR_MMAP;
+    }
+
+    i64 ticks = record_game(bench, state, turns, turns_capacity);
+    clear_game(state);
+    for (i64 i = 0; i < ticks / 2; ++i) {
+        replay_tick(state, &turns[i]);
+    }
+
+    i32 cpus = cpu_count();
+    u64 counts_len = sizeof(thread_counts) / sizeof(*thread_counts);
+    char variant[64];
+    for (i32 mode = RENDER_MODE_SPAN; mode <= RENDER_MODE_EXPAND; ++mode) {
+        for (u64 i = 0; i < counts_len; ++i) {
+            if (thread_counts[i] > cpus) {
+                break;
+            }
+            struct arena pool_arena = arena;
+            struct renderer renderer;
+            i32 error = renderer_init(
+                &renderer,
+                &pool_arena,
+                (enum render_mode)mode,
+                PIXEL_FORMAT_XRGB8888,
+                resolution->width,
+                resolution->height,
+                state
+            );
+            if (error != 0) {
+                return BENCH_ERROR_RENDERER_INIT;
+            }
+            error = band_pool_init(
+                pool,
+                &pool_arena,
+                &renderer,
+                thread_counts[i]
+            );
+            if (error != 0) {
+                band_pool_stop(pool);
+                return BENCH_ERROR_ALLOC;
+            }
+            renderer.bands = pool;
+
+            for (i64 j = 0; j < samples_len; ++j) {
+                i64 start = now_ns();
+                draw_game(&renderer, &buf, state);
+                samples[j] = (u64)(now_ns() - start);
+            }
+            band_pool_stop(pool);
+
+            i64 len = append_str(variant, 0, render_mode_names[mode]);
+            len = append_str(variant, len, ".");
+            len = append_str(variant, len, resolution->name);
+            len = append_str(variant, len, ".");
+            len = append_str(variant, len, board->name);
+            len = append_str(variant, len, ".");
+            len = append_str(variant, len, names[i]);
+            append_str(variant, len, "threads");
+            report(bench, "bands", variant, "ns/frame", samples, samples_len);
+        }
+    }
+
+    munmap(buf.map, (i64)(size * sizeof(u32)));
+    return BENCH_ERROR_NONE;
+}
+
+static i32 bench_bands(struct bench *bench) {
+    struct resolution resolution = {
+        .name = "4k",
+        .width = 3840,
+        .height = 2160,
+    };
+    if (!bench_enabled(bench, "bands")) {
+        return BENCH_ERROR_NONE;
+    }
+    for (u64 i = 0; i < sizeof(board_sizes) / sizeof(*board_sizes); ++i) {
+        i32 error = bench_bands_board(bench, &resolution, &board_sizes[i]);
+        if (error != BENCH_ERROR_NONE) {
+            return error;
+        }
+    }
+    return BENCH_ERROR_NONE;
+}
+
+static i32 bench_render(struct bench *bench) {
+    struct resolution resolutions[] = {
+        { .name = "720p", .width = 1280, .height = 720 },
+        { .name = "1080p", .width = 1920, .height = 1080 },
+        { .name = "1440p", .width = 2560, .height = 1440 },
+        { .name = "4k", .width = 3840, .height = 2160 },
+    };
+    if (!bench_enabled(bench, "render")) {
+        return BENCH_ERROR_NONE;
+    }
+    for (u64 i = 0; i < sizeof(resolutions) / sizeof(*resolutions); ++i) {
+        for (u64 j = 0; j < sizeof(board_sizes) / sizeof(*board_sizes); ++j) {
+            i32 error = bench_render_resolution(
+                bench,
+                &resolutions[i],
+                &board_sizes[j]
+            );
+            if (error != BENCH_ERROR_NONE) {
+                return error;
+            }
+        }
+    }
+    return BENCH_ERROR_NONE;
+}
+
+struct bot_position {
+    u64 *board;
+    i32 width;
+    i32 height;
+    i32 x;
+    i32 y;
+    i32 vx;
+    i32 vy;
+    struct bot_head *opponents;
+    i32 opponents_len;
+};
+
+static i32 bench_bot_position(
+    struct bench *bench,
+    struct arena *arena,
+    char *name,
+    struct bot_position *position
+) {
+    i64 budgets[] = { 500 * 1000, 2 * 1000 * 1000 };
+    char *budget_names[] = { "500us", "2ms" };
+
+    struct arena position_arena = *arena;
+    i64 samples_len = 50;
+    u64 *samples = alloc(&position_arena, samples_len * (i64)sizeof(u64));
+    u64 *depths = alloc(&position_arena, samples_len * (i64)sizeof(u64));
+    u64 *overruns = alloc(&position_arena, samples_len * (i64)sizeof(u64));
+    struct bot *bot = alloc(&position_arena, sizeof(*bot));
+    if (samples == 0 || depths == 0 || overruns == 0 || bot == 0) {
+        return BENCH_ERROR_ALLOC;
+    }
+
+    char variant[64];
+    for (u64 i = 0; i < sizeof(budgets) / sizeof(*budgets); ++i) {
+        struct arena bot_arena = position_arena;
+        i32 error = bot_init(
+            bot,
+            &bot_arena,
+            position->width,
+            position->height,
+            budgets[i],
+            BOT_MAX_DEPTH
+        );
+        if (error != 0) {
+            return BENCH_ERROR_ALLOC;
+        }
+
+        for (i64 j = 0; j < samples_len; ++j) {
+            i32 vx, vy;
+            i64 start = now_ns();
+            i32 depth = bot_choose(
+                bot,
+                position->board,
+                position->x,
+                position->y,
+                position->vx,
+                position->vy,
+                position->opponents,
+                position->opponents_len,
+                &vx,
+                &vy
+            );
+            i64 elapsed = now_ns() - start;
+            samples[j] = (u64)elapsed;
+            depths[j] = (u64)depth;
+            overruns[j] = 0;
+            if (elapsed > budgets[i]) {
+                overruns[j] = (u64)(elapsed - budgets[i]);
+            }
+        }
+
+        i64 len = append_str(variant, 0, name);
+        len = append_str(variant, len, ".");
+        append_str(variant, len, budget_names[i]);
+        report(bench, "bot", variant, "ns/decision", samples, samples_len);
+        report(bench, "bot", variant, "plies", depths, samples_len);
+        report(bench, "bot", variant, "ns overrun", overruns, samples_len);
+    }
+
+    return BENCH_ERROR_NONE;
+}
+
+static i32 bench_bot_board(struct bench *bench, struct board_size *board) {
+    struct arena arena = bench->arena;
+    struct game_state *state = bench_game_state(&arena, board);
+    i64 turns_capacity = board->width * board->height;
+    struct turn *turns = alloc(&arena, turns_capacity * (i64)sizeof(*turns));
+    if (state == 0 || turns == 0) {
+        return BENCH_ERROR_ALLOC;
+    }
+
+    i64 ticks = record_game(bench, state, turns, turns_capacity);
+    clear_game(state);
+    for (i64 i = 0; i < ticks / 2; ++i) {
+        replay_tick(state, &turns[i]);
+    }
+
+    struct bot_position position = {
+        .board = state->board,
+        .width = state->width,
+        .height = state->height,
+        .x = state->x,
+        .y = state->y,
+        .vx = state->vx,
+        .vy = state->vy,
+        .opponents = 0,
+        .opponents_len = 0,
+    };
+    i32 error = bench_bot_position(bench, &arena, board->name, &position);
+    if (error != BENCH_ERROR_NONE) {
+        return error;
+    }
+
+    i32 cycles_len = 4;
+    i32 ticks_capacity = board->height / 2;
+    i64 events_capacity = ticks_capacity * cycles_len;
+    struct match match;
+    error = match_init(&match, &arena, board->width, board->height, cycles_len);
+    i64 *tick_ends = alloc(&arena, ticks_capacity * (i64)sizeof(i64));
+    struct match_event *events = alloc(
+        &arena,
+        events_capacity * (i64)sizeof(*events)
+    );
+    struct bot_head *opponents = alloc(
+        &arena,
+        cycles_len * (i64)sizeof(*opponents)
+    );
+    if (error != 0 || tick_ends == 0 || events == 0 || opponents == 0) {
+        return BENCH_ERROR_ALLOC;
+    }
+
+    record_match(
+        bench,
+        &match,
+        events,
+        events_capacity,
+        tick_ends,
+        ticks_capacity
+    );
+    if (match.alive_len < 2) {
+        return BENCH_ERROR_NONE;
+    }
+    i32 cycle = match.alive[0];
+    for (i32 i = 1; i < match.alive_len; ++i) {
+        opponents[i - 1].x = match.x[match.alive[i]];
+        opponents[i - 1].y = match.y[match.alive[i]];
+    }
+    position.board = match.board;
+    position.x = match.x[cycle];
+    position.y = match.y[cycle];
+    position.vx = match.vx[cycle];
+    position.vy = match.vy[cycle];
+    position.opponents = opponents;
+    position.opponents_len = match.alive_len - 1;
+
+    char name[64];
+    i64 len = append_str(name, 0, board->name);
+    append_str(name, len, ".4cycles");
+    return bench_bot_position(bench, &arena, name, &position);
+}
+
+static i32 bench_bot(struct bench *bench) {
+    if (!bench_enabled(bench, "bot")) {
+        return BENCH_ERROR_NONE;
+    }
+    for (u64 i = 0; i < sizeof(board_sizes) / sizeof(*board_sizes); ++i) {
+        i32 error = bench_bot_board(bench, &board_sizes[i]);
+        if (error != BENCH_ERROR_NONE) {
+            return error;
+        }
+    }
+    return BENCH_ERROR_NONE;
+}
+
+static i32 bench_mcts(struct bench *bench) {
+    if (!bench_enabled(bench, "mcts")) {
+        return BENCH_ERROR_NONE;
+    }
+
+    i32 thread_counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+    char *names[] = { "1", "2", "4", "8", "16", "32", "64" };
+    i64 budget_ns = 4 * 1000 * 1000;
+    struct arena arena = bench->arena;
+    struct game_state *state = bench_game_state(&arena, &board_sizes[0]);
+    i64 turns_capacity = state->width * state->height;
+    struct turn *turns = alloc(&arena, turns_capacity * (i64)sizeof(*turns));
+    i64 samples_len = 25;
+    u64 *rates = alloc(&arena, samples_len * (i64)sizeof(*rates));
+    u64 *core_rates = alloc(&arena, samples_len * (i64)sizeof(*core_rates));
+    struct mcts *mcts = alloc(&arena, sizeof(*mcts));
+    if (
+        state == 0 ||
+        turns == 0 ||
+        rates == 0 ||
+        core_rates == 0 ||
+        mcts == 0
+    ) {
+        return BENCH_ERROR_ALLOC;
+    }
+
+    i64 ticks = record_game(bench, state, turns, turns_capacity);
+    clear_game(state);
+    for (i64 i = 0; i < ticks / 2; ++i) {
+        replay_tick(state, &turns[i]);
+    }
+
+    i32 cpus = cpu_count();
+    char variant[64];
+    for (u64 i = 0; i < sizeof(thread_counts) / sizeof(*thread_counts); ++i) {
+        i32 threads = thread_counts[i];
+        if (threads > cpus) {
+            break;
+        }
+        struct arena mcts_arena = arena;
+        i32 error = mcts_init(
+            mcts,
+            &mcts_arena,
+            state->width,
+            state->height,
+            budget_ns,
+            threads,
+            1024 * 1024
+        );
+        if (error != 0) {
+            mcts_stop(mcts);
+            return BENCH_ERROR_ALLOC;
+        }
+
+        for (i64 j = 0; j < samples_len; ++j) {
+            i32 vx, vy;
+            i64 start = now_ns();
+            u64 rollouts = mcts_choose(
+                mcts,
+                state->board,
+                state->x,
+                state->y,
+                state->vx,
+                state->vy,
+                &vx,
+                &vy
+            );
+            i64 elapsed = now_ns() - start;
+            rates[j] = rollouts * 1000UL * 1000UL * 1000UL / (u64)elapsed;
+            core_rates[j] = rates[j] / (u64)threads;
+        }
+        mcts_stop(mcts);
+
+        i64 len = append_str(variant, 0, board_sizes[0].name);
+        len = append_str(variant, len, ".");
+        len = append_str(variant, len, names[i]);
+        append_str(variant, len, "threads");
+        report(bench, "mcts", variant, "rollouts/s", rates, samples_len);
+        report(
+            bench,
+            "mcts",
+            variant,
+            "rollouts/s/core",
+            core_rates,
+            samples_len
+        );
+    }
+
+    return BENCH_ERROR_NONE;
+}
+
+static i32 bench_multi(struct bench *bench) {
+    i32 cycle_counts[] = { 1, 4, 16, 64, 256, 1024, 4096 };
+    char *names[] = { "1", "4", "16", "64", "256", "1024", "4096" };
+    if (!bench_enabled(bench, "multi")) {
+        return BENCH_ERROR_NONE;
+    }
+
+    i64 samples_len = 50;
+    i32 ticks_capacity = 256;
+    i64 events_capacity = 256 * 1024;
+    struct arena arena = bench->arena;
+    u64 *samples = alloc(&arena, samples_len * (i64)sizeof(*samples));
+    u64 *rates = alloc(&arena, samples_len * (i64)sizeof(*rates));
+    u64 *cycle_samples = alloc(&arena, samples_len * (i64)sizeof(u64));
+    i64 *tick_ends = alloc(&arena, ticks_capacity * (i64)sizeof(i64));
+    struct match_event *events = alloc(
+        &arena,
+        events_capacity * (i64)sizeof(*events)
+    );
+    if (
+        samples == 0 ||
+        rates == 0 ||
+        cycle_samples == 0 ||
+        tick_ends == 0 ||
+        events == 0
+    ) {
+        return BENCH_ERROR_ALLOC;
+    }
+
+    for (u64 i = 0; i < sizeof(cycle_counts) / sizeof(*cycle_counts); ++i) {
+        struct arena match_arena = arena;
+        struct match match;
+        i32 error = match_init(&match, &match_arena, 512, 512, cycle_counts[i]);
+        if (error != 0) {
+            return BENCH_ERROR_ALLOC;
+        }
+
+        i32 ticks = record_match(
+            bench,
+            &match,
+            events,
+            events_capacity,
+            tick_ends,
+            ticks_capacity
+        );
+        if (ticks == 0) {
+            continue;
+        }
+
+        for (i64 j = 0; j < samples_len; ++j) {
+            match_reset(&match);
+            i64 cycle_ticks = 0;
+            i64 next = 0;
+            i64 start = now_ns();
+            for (i32 tick = 0; tick < ticks; ++tick) {
+                for (; next < tick_ends[tick]; ++next) {
+                    match_turn(
+                        &match,
+                        events[next].cycle,
+                        events[next].turn.vx,
+                        events[next].turn.vy
+                    );
+                }
+                cycle_ticks += match.alive_len;
+                match_update(&match);
+            }
+            u64 elapsed = (u64)(now_ns() - start);
+            samples[j] = elapsed / (u64)ticks;
+            rates[j] = ((u64)ticks * 1000UL * 1000UL * 1000UL) / elapsed;
+            cycle_samples[j] = elapsed / (u64)cycle_ticks;
+        }
+        report(bench, "multi", names[i], "ns/tick", samples, samples_len);
+        report(bench, "multi", names[i], "ticks/s", rates, samples_len);
+        report(
+            bench,
+            "multi",
+            names[i],
+            "ns/cycle",
+            cycle_samples,
+            samples_len
+        );
+    }
+
+    return BENCH_ERROR_NONE;
+}
+
+static i32 bench_alloc(struct bench *bench) {
+    i64 sizes[] = { 64, 4096, 64 * 1024, 1024 * 1024 };
+    char *names[] = { "64", "4096", "65536", "1048576" };
+    i64 calls[] = { 1000, 1000, 256, 16 };
+    i64 uninit_calls = 1000;
+    if (!bench_enabled(bench, "alloc")) {
+        return BENCH_ERROR_NONE;
+    }
+
+    i64 samples_len = 100;
+    struct arena arena = bench->arena;
+    u64 *samples = alloc(&arena, samples_len * (i64)sizeof(*samples));
+    if (samples == 0) {
+        return BENCH_ERROR_ALLOC;
+    }
+
+    struct arena_checkpoint checkpoint = arena_save(&arena);
+    for (u64 i = 0; i < sizeof(sizes) / sizeof(*sizes); ++i) {
+        for (i64 j = 0; j < samples_len; ++j) {
+            i64 start = now_ns();
+            for (i64 k = 0; k < calls[i]; ++k) {
+                void *p = alloc(&arena, sizes[i]);
+                arena_restore(&arena, checkpoint);
+                if (p == 0) {
+                    return BENCH_ERROR_ALLOC;
+                }
+            }
+            samples[j] = (u64)(now_ns() - start) / (u64)calls[i];
+        }
+        report(bench, "alloc", names[i], "ns/call", samples, samples_len);
+
+        for (i64 j = 0; j < samples_len; ++j) {
+            i64 start = now_ns();
+            for (i64 k = 0; k < uninit_calls; ++k) {
+                void *p = alloc_uninit(&arena, sizes[i]);
+                arena_restore(&arena, checkpoint);
+                if (p == 0) {
+                    return BENCH_ERROR_ALLOC;
+                }
+            }
+            samples[j] = (u64)(now_ns() - start) / (u64)uninit_calls;
+        }
+        report(
+            bench,
+            "alloc.uninit",
+            names[i],
+            "ns/call",
+            samples,
+            samples_len
+        );
+    }
+
+    return BENCH_ERROR_NONE;
+}
+
+enum bench_memory_layout {
+    BENCH_MEMORY_SIZE = 32 * 1024 * 1024,
+    BENCH_MEMORY_BYTES_PER_SAMPLE = 1024 * 1024,
+};
+
+struct memory_size {
+    char *name;
+    u64 size;
+};
+
+struct memset_variant {
+    char *name;
+    u32 features;
+    void *(*call)(void *dst, i32 value, u64 len);
+};
+
+struct memcpy_variant {
+    char *name;
+    u32 features;
+    void *(*call)(void *dst, void *src, u64 len);
+};
+
+struct fill32_variant {
+    char *name;
+    u32 features;
+    void (*call)(u32 *dst, u64 len, u32 value);
+};
+
+static i32 bench_memory(struct bench *bench) {
+    struct memory_size sizes[] = {
+        { "64", 64 },
+        { "4096", 4096 },
+        { "65536", 64 * 1024 },
+        { "1048576", 1024 * 1024 },
+        { "33554432", BENCH_MEMORY_SIZE },
+    };
+    struct memset_variant memsets[] = {
+        { "memset.erms", 0, memset },
+        { "memset.avx2", CPU_FEATURE_AVX2, memset_avx2 },
+        { "memset.stream", 0, memset_stream },
+    };
+    struct memcpy_variant memcpys[] = {
+        { "memcpy.erms", 0, memcpy },
+        { "memcpy.avx2", CPU_FEATURE_AVX2, memcpy_avx2 },
+        { "memcpy.stream", 0, memcpy_stream },
+    };
+    struct fill32_variant fills[] = {
+        { "fill32.rep", 0, fill32_rep },
+        { "fill32.sse2", 0, fill32_sse2 },
+        { "fill32.avx2", CPU_FEATURE_AVX2, fill32_avx2 },
+    };
+    if (
+        !bench_enabled(bench, "memset") &&
+        !bench_enabled(bench, "memcpy") &&
+        !bench_enabled(bench, "fill32")
+    ) {
+        return BENCH_ERROR_NONE;
+    }
+
+    i64 samples_len = 50;
+    struct arena arena = bench->arena;
+    u64 *samples = alloc(&arena, samples_len * (i64)sizeof(*samples));
+    if (samples == 0) {
+        return BENCH_ERROR_ALLOC;
+    }
+    char *dst = mmap(
+        0,
+        BENCH_MEMORY_SIZE,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+    char *src = mmap(
+        0,
+        BENCH_MEMORY_SIZE,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+    if (dst == 0 || src == 0) {
+        return BENCH_ERROR_MMAP;
+    }
+    memset(dst, 0, BENCH_MEMORY_SIZE);
+    memset(src, 0x5a, BENCH_MEMORY_SIZE);
+
+    u32 features = cpu_features();
+    for (u64 i = 0; i < sizeof(sizes) / sizeof(*sizes); ++i) {
+        u64 size = sizes[i].size;
+        u64 reps = BENCH_MEMORY_BYTES_PER_SAMPLE / size;
+        if (reps == 0) {
+            reps = 1;
+        }
+
+        for (u64 j = 0; j < sizeof(memsets) / sizeof(*memsets); ++j) {
+            struct memset_variant *variant = &memsets[j];
+            if (
+                !bench_enabled(bench, variant->name) ||
+                (features & variant->features) != variant->features
+            ) {
+                continue;
+            }
+            for (i64 k = 0; k < samples_len; ++k) {
+                i64 start = now_ns();
+                for (u64 r = 0; r < reps; ++r) {
+                    variant->call(dst, (i32)r, size);
+                }
+                samples[k] = (u64)(now_ns() - start) / reps;
+            }
+            report(
+                bench,
+                variant->name,
+                sizes[i].name,
+                "ns/call",
+                samples,
+                samples_len
+            );
+        }
+
+        for (u64 j = 0; j < sizeof(memcpys) / sizeof(*memcpys); ++j) {
+            struct memcpy_variant *variant = &memcpys[j];
+            if (
+                !bench_enabled(bench, variant->name) ||
+                (features & variant->features) != variant->features
+            ) {
+                continue;
+            }
+            for (i64 k = 0; k < samples_len; ++k) {
+                i64 start = now_ns();
+                for (u64 r = 0; r < reps; ++r) {
+                    variant->call(dst, src, size);
+                }
+                samples[k] = (u64)(now_ns() - start) / reps;
+            }
+            report(
+                bench,
+                variant->name,
+                sizes[i].name,
+                "ns/call",
+                samples,
+                samples_len
+            );
+        }
+
+        for (u64 j = 0; j < sizeof(fills) / sizeof(*fills); ++j) {
+            struct fill32_variant *variant = &fills[j];
+            if (
+                !bench_enabled(bench, variant->name) ||
+                (features & variant->features) != variant->features
+            ) {
+                continue;
+            }
+            for (i64 k = 0; k < samples_len; ++k) {
+                i64 start = now_ns();
+                for (u64 r = 0; r < reps; ++r) {
+                    variant->call((u32 *)(void *)dst, size / 4, (u32)r);
+                }
+                samples[k] = (u64)(now_ns() - start) / reps;
+            }
+            report(
+                bench,
+                variant->name,
+                sizes[i].name,
+                "ns/call",
+                samples,
+                samples_len
+            );
+        }
+    }
+
+    munmap(dst, BENCH_MEMORY_SIZE);
+    munmap(src, BENCH_MEMORY_SIZE);
+    return BENCH_ERROR_NONE;
+}
+
+static i32 bench_syscalls(struct bench *bench) {
+    char *names[] = {
+        "syscall0",
+        "syscall1",
+        "syscall2",
+        "syscall3",
+        "syscall4",
+        "syscall5",
+        "syscall6",
+    };
+    if (!bench_enabled(bench, "syscall")) {
+        return BENCH_ERROR_NONE;
+    }
+
+    i64 samples_len = 200;
+    i64 calls = 1000;
+    struct arena arena = bench->arena;
+    u64 *samples = alloc(&arena, samples_len * (i64)sizeof(*samples));
+    if (samples == 0) {
+        return BENCH_ERROR_ALLOC;
+    }
+
+    for (i32 arity = 0; arity <= 6; ++arity) {
+        for (i64 i = 0; i < samples_len; ++i) {
+            i64 start = now_ns();
+            for (i64 j = 0; j < calls; ++j) {
+                switch (arity) {
+                    case 0:
+                        syscall0(SYS_GETPID);
+                        break;
+                    case 1:
+                        syscall1(SYS_GETPID, 1);
+                        break;
+                    case 2:
+                        syscall2(SYS_GETPID, 1, 2);
+                        break;
+                    case 3:
+                        syscall3(SYS_GETPID, 1, 2, 3);
+                        break;
+                    case 4:
+                        syscall4(SYS_GETPID, 1, 2, 3, 4);
+                        break;
+                    case 5:
+                        syscall5(SYS_GETPID, 1, 2, 3, 4, 5);
+                        break;
+                    default:
+                        syscall6(SYS_GETPID, 1, 2, 3, 4, 5, 6);
+                        break;
+                }
+            }
+            samples[i] = (u64)(now_ns() - start) / (u64)calls;
+        }
+        report(bench, names[arity], 0, "ns/call", samples, samples_len);
+    }
+
+    return BENCH_ERROR_NONE;
+}
+
+static void bench_close_calls(
+    struct bench *bench,
+    char *variant,
+    u64 *samples,
+    i64 samples_len,
+    i64 calls
+) {
+    for (i64 i = 0; i < samples_len; ++i) {
+        i64 start = now_ns();
+        for (i64 j = 0; j < calls; ++j) {
+            close(-1);
+        }
+        samples[i] = (u64)(now_ns() - start) / (u64)calls;
+    }
+    report(bench, "syscall.close", variant, "ns/call", samples, samples_len);
+}
+
+static u64 passthrough_call(void *ctx, u64 scid, u64 *args) {
+    (void)ctx;
+    return syscall6(scid, args[0], args[1], args[2], args[3], args[4], args[5]);
+}
+
+static i32 bench_syscall_layer(struct bench *bench) {
+    if (!bench_enabled(bench, "syscall.close")) {
+        return BENCH_ERROR_NONE;
+    }
+
+    i64 samples_len = 200;
+    i64 calls = 1000;
+    struct arena arena = bench->arena;
+    u64 *samples = alloc(&arena, samples_len * (i64)sizeof(*samples));
+    struct syscall_stats *stats = alloc(&arena, sizeof(*stats));
+    if (samples == 0 || stats == 0) {
+        return BENCH_ERROR_ALLOC;
+    }
+
+    bench_close_calls(bench, 0, samples, samples_len, calls);
+
+    struct syscall_layer layer = { .call = passthrough_call, .ctx = 0 };
+    syscall_layer_set(&layer);
+    bench_close_calls(bench, "layer", samples, samples_len, calls);
+    syscall_layer_set(0);
+
+    syscall_stats_enable(stats);
+    bench_close_calls(bench, "stats", samples, samples_len, calls);
+    syscall_stats_disable();
+
+    return BENCH_ERROR_NONE;
+}
+
+static i32 bench_fake_drm(struct bench *bench) {
+    if (!bench_enabled(bench, "fakedrm")) {
+        return BENCH_ERROR_NONE;
+    }
+
+    i64 samples_len = 200;
+    struct arena arena = bench->arena;
+    u64 *samples = alloc(&arena, samples_len * (i64)sizeof(*samples));
+    struct fake_drm *fake = alloc(&arena, sizeof(*fake));
+    if (samples == 0 || fake == 0) {
+        return BENCH_ERROR_ALLOC;
+    }
+    i32 error = fake_drm_init(fake, 1920, 1080, 100000, "", 0);
+    if (error != 0) {
+        return BENCH_ERROR_FAKE_DRM;
+    }
+    syscall_layer_set(&fake->layer);
+
+    i32 fd = open("/dev/dri/card0", O_RDWR, 0);
+    for (i64 i = 0; i < samples_len && fd >= 0; ++i) {
+        u32 ids[3][4];
+        struct drm_mode_resources res = { 0 };
+        i64 start = now_ns();
+        error = ioctl(
+            fd,
+            IOCTL_RDWR,
+            IOCTL_DRM,
+            DRM_IOCTL_MODE_GET_RESOURCES,
+            sizeof(res),
+            (char *)&res
+        );
+        res.crtcs = ids[0];
+        res.connectors = ids[1];
+        res.encoders = ids[2];
+        error |= ioctl(
+            fd,
+            IOCTL_RDWR,
+            IOCTL_DRM,
+            DRM_IOCTL_MODE_GET_RESOURCES,
+            sizeof(res),
+            (char *)&res
+        );
+        samples[i] = (u64)(now_ns() - start);
+        if (error != 0) {
+            fd = -1;
+        }
+    }
+    if (fd >= 0) {
+        report(
+            bench,
+            "fakedrm.get_resources",
+            0,
+            "ns/call",
+            samples,
+            samples_len
+        );
+    }
+
+    struct drm_mode_create_dumb creq = {
+        .width = 1920,
+        .height = 1080,
+        .bpp = 32,
+    };
+    struct drm_mode_fb_cmd fb_cmd = { 0 };
+    if (fd >= 0) {
+        error = ioctl(
+            fd,
+            IOCTL_RDWR,
+            IOCTL_DRM,
+            DRM_IOCTL_MODE_CREATE_DUMB,
+            sizeof(creq),
+            (char *)&creq
+        );
+        fb_cmd.handle = creq.handle;
+        error |= ioctl(
+            fd,
+            IOCTL_RDWR,
+            IOCTL_DRM,
+            DRM_IOCTL_MODE_ADD_FB,
+            sizeof(fb_cmd),
+            (char *)&fb_cmd
+        );
+        if (error != 0) {
+            fd = -1;
+        }
+    }
+    for (i64 i = 0; i < samples_len && fd >= 0; ++i) {
+        struct drm_mode_crtc_page_flip flip = {
+            .crtc_id = 31,
+            .fb_id = fb_cmd.fb_id,
+            .flags = 1,
+        };
+        char event[64];
+        i64 start = now_ns();
+        error = ioctl(
+            fd,
+            IOCTL_RDWR,
+            IOCTL_DRM,
+            DRM_IOCTL_MODE_PAGE_FLIP,
+            sizeof(flip),
+            (char *)&flip
+        );
+        if (error != 0 || read(fd, event, sizeof(event)) <= 0) {
+            fd = -1;
+        }
+        samples[i] = (u64)(now_ns() - start);
+    }
+    syscall_layer_set(0);
+    if (fd < 0) {
+        return BENCH_ERROR_FAKE_DRM;
+    }
+    report(bench, "fakedrm.flip", 0, "ns/flip", samples, samples_len);
+
+    return BENCH_ERROR_NONE;
+}
+
+i32 main(i32 argc, char **argv) {
+    i64 arena_size = 2000 * 4096;
+    char *mem = mmap(
+        0,
+        arena_size,
+        PROT_WRITE | PROT_READ,
+        MAP_SHARED | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+    if (mem == 0) {
+        return BENCH_ERROR_MMAP;
+    }
+
+    struct bench bench;
+    arena_init(&bench.arena, mem, arena_size);
+    bench.out.fd = STDOUT;
+    bench.out.len = 0;
+    bench.filters = argv + 1;
+    bench.filters_len = argc - 1;
+    bench.rng = 0x2545f4914f6cdd1dUL;
+
+    print_str(&bench.out, "benchmark\tunit\tsamples\tmin\tmedian\tp99\n");
+    print_flush(&bench.out);
+
+    i32 error = bench_syscalls(&bench);
+    if (error == BENCH_ERROR_NONE) {
+        error = bench_syscall_layer(&bench);
+    }
+    if (error == BENCH_ERROR_NONE) {
+        error = bench_fake_drm(&bench);
+    }
+    if (error == BENCH_ERROR_NONE) {
+        error = bench_alloc(&bench);
+    }
+    if (error == BENCH_ERROR_NONE) {
+        error = bench_memory(&bench);
+    }
+    if (error == BENCH_ERROR_NONE) {
+        error = bench_game(&bench);
+    }
+    if (error == BENCH_ERROR_NONE) {
+        error = bench_render(&bench);
+    }
+    if (error == BENCH_ERROR_NONE) {
+        error = bench_bands(&bench);
+    }
+    if (error == BENCH_ERROR_NONE) {
+        error = bench_multi(&bench);
+    }
+    if (error == BENCH_ERROR_NONE) {
+        error = bench_bot(&bench);
+    }
+    if (error == BENCH_ERROR_NONE) {
+        error = bench_mcts(&bench);
+    }
+    return error;
+}
+
+void _cstart(i32 argc, char **argv) {
+    exit(main(argc, argv));
+}
@@ -0,0 +1,359 @@
+#include "dumb_cycle.h"
+
+enum bot_fill_limits {
+    BOT_FILL_STEPS = 24,
+    BOT_FILL_CHECK_MASK = 7,
+};
+
+enum bot_score {
+    BOT_SCORE_DEAD = -(1 << 30),
+};
+
+static i64 bot_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.sec * 1000L * 1000L * 1000L + now.nsec;
+}
+
+static i32 bot_timed_out(struct bot *bot) {
+    if (bot->budget_ns == 0) {
+        return 0;
+    }
+    if (!bot->aborted && bot_now_ns() >= bot->deadline_ns) {
+        bot->aborted = 1;
+    }
+    return bot->aborted;
+}
+
+i32 bot_init(
+    struct bot *bot,
+    struct arena *arena,
+    i32 width,
+    i32 height,
+    i64 budget_ns,
+    i32 max_depth
+) {
+    i32 row_words = (width + 63) / 64;
+    i64 size = height * row_words * (i64)sizeof(u64);
+    bot->budget_ns = budget_ns;
+    bot->max_depth = max_depth;
+    bot->depth = 0;
+    bot->nodes = 0;
+    bot->width = width;
+    bot->height = height;
+    bot->row_words = row_words;
+    bot->last_mask = ~0UL;
+    if (width % 64 != 0) {
+        bot->last_mask = (1UL << (width % 64)) - 1;
+    }
+    bot->board = alloc(arena, size);
+    bot->mine.visited = alloc(arena, size);
+    bot->mine.front = alloc(arena, size);
+    bot->mine.next = alloc(arena, size);
+    bot->theirs.visited = alloc(arena, size);
+    bot->theirs.front = alloc(arena, size);
+    bot->theirs.next = alloc(arena, size);
+    if (
+        bot->board == 0 ||
+        bot->mine.visited == 0 ||
+        bot->mine.front == 0 ||
+        bot->mine.next == 0 ||
+        bot->theirs.visited == 0 ||
+        bot->theirs.front == 0 ||
+        bot->theirs.next == 0
+    ) {
+        return -1;
+    }
+    bot->mine.dirty_lo = height;
+    bot->mine.dirty_hi = -1;
+    bot->theirs.dirty_lo = height;
+    bot->theirs.dirty_hi = -1;
+    return 0;
+}
+
+static i64 popcount(u64 x) {
+    x = x - ((x >> 1) & 0x5555555555555555UL);
+    x = (x & 0x3333333333333333UL) + ((x >> 2) & 0x3333333333333333UL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fUL;
+    return (i64)((x * 0x0101010101010101UL) >> 56);
+}
+
+static i32 bot_cell_free(struct bot *bot, i32 x, i32 y) {
+    if (x < 0 || x >= bot->width || y < 0 || y >= bot->height) {
+        return 0;
+    }
+    u64 word = bot->board[y * bot->row_words + x / 64];
+    return ((word >> (x % 64)) & 1) == 0;
+}
+
+static void bot_flip_cell(struct bot *bot, i32 x, i32 y) {
+    bot->board[y * bot->row_words + x / 64] ^= 1UL << (x % 64);
+}
+
+static void bot_fill_start(struct bot *bot, struct bot_fill *fill) {
+    if (fill->dirty_lo <= fill->dirty_hi) {
+        i32 start = fill->dirty_lo * bot->row_words;
+        i32 rows = fill->dirty_hi - fill->dirty_lo + 1;
+        u64 size = (u64)(rows * bot->row_words) * sizeof(u64);
+        memset(&fill->visited[start], 0, size);
+        memset(&fill->front[start], 0, size);
+    }
+    fill->lo = bot->height;
+    fill->hi = -1;
+    fill->dirty_lo = bot->height;
+    fill->dirty_hi = -1;
+}
+
+static void bot_fill_add(
+    struct bot *bot,
+    struct bot_fill *fill,
+    i32 x,
+    i32 y
+) {
+    u64 bit = 1UL << (x % 64);
+    fill->visited[y * bot->row_words + x / 64] |= bit;
+    fill->front[y * bot->row_words + x / 64] |= bit;
+    if (y < fill->lo) {
+        fill->lo = y;
+    }
+    if (y > fill->hi) {
+        fill->hi = y;
+    }
+    if (y < fill->dirty_lo) {
+        fill->dirty_lo = y;
+    }
+    if (y > fill->dirty_hi) {
+        fill->dirty_hi = y;
+    }
+}
+
+static void bot_fill_grow(struct bot *bot, struct bot_fill *fill) {
+    if (fill->lo > fill->hi) {
+        fill->grow_lo = bot->height;
+        fill->grow_hi = -1;
+        return;
+    }
+    fill->grow_lo = (fill->lo > 0) ? fill->lo - 1 : 0;
+    fill->grow_hi = fill->hi + 1;
+    if (fill->grow_hi >= bot->height) {
+        fill->grow_hi = bot->height - 1;
+    }
+    if (fill->grow_lo < fill->dirty_lo) {
+        fill->dirty_lo = fill->grow_lo;
+    }
+    if (fill->grow_hi > fill->dirty_hi) {
+        fill->dirty_hi = fill->grow_hi;
+    }
+
+    i32 row_words = bot->row_words;
+    for (i32 y = fill->grow_lo; y <= fill->grow_hi; ++y) {
+        u64 *row = &fill->front[y * row_words];
+        for (i32 w = 0; w < row_words; ++w) {
+            u64 cells = row[w];
+            u64 grown = cells | (cells << 1) | (cells >> 1);
+            if (w > 0) {
+                grown |= row[w - 1] >> 63;
+            }
+            if (w + 1 < row_words) {
+                grown |= row[w + 1] << 63;
+            }
+            if (y > 0) {
+                grown |= row[w - row_words];
+            }
+            if (y + 1 < bot->height) {
+                grown |= row[w + row_words];
+            }
+            if (w + 1 == row_words) {
+                grown &= bot->last_mask;
+            }
+            i32 i = y * row_words + w;
+            fill->next[i] = grown & ~bot->board[i] & ~fill->visited[i];
+        }
+    }
+}
+
+static i64 bot_territory(struct bot *bot, i32 x, i32 y) {
+    struct bot_fill *mine = &bot->mine;
+    struct bot_fill *theirs = &bot->theirs;
+    bot_fill_start(bot, mine);
+    bot_fill_start(bot, theirs);
+    bot_fill_add(bot, mine, x, y);
+    for (i32 i = 0; i < bot->opponents_len; ++i) {
+        bot_fill_add(bot, theirs, bot->opponents[i].x, bot->opponents[i].y);
+    }
+
+    i32 row_words = bot->row_words;
+    i64 score = 0;
+    for (i32 step = 0; step < BOT_FILL_STEPS; ++step) {
+        if ((step & BOT_FILL_CHECK_MASK) == 0 && bot_timed_out(bot)) {
+            return 0;
+        }
+
+        bot_fill_grow(bot, mine);
+        bot_fill_grow(bot, theirs);
+        i32 lo = mine->grow_lo;
+        i32 hi = mine->grow_hi;
+        if (theirs->grow_lo < lo) {
+            lo = theirs->grow_lo;
+        }
+        if (theirs->grow_hi > hi) {
+            hi = theirs->grow_hi;
+        }
+        if (lo > hi) {
+            return score;
+        }
+
+        mine->lo = bot->height;
+        mine->hi = -1;
+        theirs->lo = bot->height;
+        theirs->hi = -1;
+        for (i32 row = lo; row <= hi; ++row) {
+            i32 in_mine = row >= mine->grow_lo && row <= mine->grow_hi;
+            i32 in_theirs = row >= theirs->grow_lo && row <= theirs->grow_hi;
+            u64 mine_row = 0;
+            u64 theirs_row = 0;
+            for (i32 w = 0; w < row_words; ++w) {
+                i32 i = row * row_words + w;
+                u64 m = in_mine ? mine->next[i] & ~theirs->visited[i] : 0;
+                u64 t = in_theirs ? theirs->next[i] & ~mine->visited[i] : 0;
+                score += popcount(m & ~t) - popcount(t & ~m);
+                mine->visited[i] |= m;
+                theirs->visited[i] |= t;
+                if (in_mine) {
+                    mine->front[i] = m;
+                }
+                if (in_theirs) {
+                    theirs->front[i] = t;
+                }
+                mine_row |= m;
+                theirs_row |= t;
+            }
+            if (mine_row != 0) {
+                if (row < mine->lo) {
+                    mine->lo = row;
+                }
+                mine->hi = row;
+            }
+            if (theirs_row != 0) {
+                if (row < theirs->lo) {
+                    theirs->lo = row;
+                }
+                theirs->hi = row;
+            }
+        }
+    }
+    return score;
+}
+
+static i64 bot_search(
+    struct bot *bot,
+    i32 x,
+    i32 y,
+    i32 vx,
+    i32 vy,
+    i32 depth
+) {
+    bot->nodes += 1;
+    if (depth == 0) {
+        return bot_territory(bot, x, y);
+    }
+
+    i32 options[3][2] = { { vx, vy }, { vy, -vx }, { -vy, vx } };
+    i64 best = BOT_SCORE_DEAD - depth;
+    for (i32 i = 0; i < 3; ++i) {
+        i32 nx = x + options[i][0];
+        i32 ny = y + options[i][1];
+        if (!bot_cell_free(bot, nx, ny)) {
+            continue;
+        }
+        bot_flip_cell(bot, nx, ny);
+        i64 score = bot_search(
+            bot,
+            nx,
+            ny,
+            options[i][0],
+            options[i][1],
+            depth - 1
+        );
+        bot_flip_cell(bot, nx, ny);
+        if (bot->aborted) {
+            return 0;
+        }
+        if (score > best) {
+            best = score;
+        }
+    }
+    return best;
+}
+
+i32 bot_choose(
+    struct bot *bot,
+    u64 *board,
+    i32 x,
+    i32 y,
+    i32 vx,
+    i32 vy,
+    struct bot_head *opponents,
+    i32 opponents_len,
+    i32 *turn_vx,
+    i32 *turn_vy
+) {
+    bot->deadline_ns = bot_now_ns() + bot->budget_ns;
+    bot->aborted = 0;
+    bot->depth = 0;
+    bot->nodes = 0;
+    bot->opponents = opponents;
+    bot->opponents_len = opponents_len;
+    memcpy(
+        bot->board,
+        board,
+        (u64)(bot->height * bot->row_words) * sizeof(u64)
+    );
+    bot->board[y * bot->row_words + x / 64] |= 1UL << (x % 64);
+
+    *turn_vx = vx;
+    *turn_vy = vy;
+    i32 options[3][2] = { { vx, vy }, { vy, -vx }, { -vy, vx } };
+    for (i32 i = 2; i >= 0; --i) {
+        if (bot_cell_free(bot, x + options[i][0], y + options[i][1])) {
+            *turn_vx = options[i][0];
+            *turn_vy = options[i][1];
+        }
+    }
+    for (i32 depth = 1; depth <= bot->max_depth; ++depth) {
+        i64 best = BOT_SCORE_DEAD - depth;
+        i32 best_option = -1;
+        for (i32 i = 0; i < 3; ++i) {
+            i32 nx = x + options[i][0];
+            i32 ny = y + options[i][1];
+            if (!bot_cell_free(bot, nx, ny)) {
+                continue;
+            }
+            bot_flip_cell(bot, nx, ny);
+            i64 score = bot_search(
+                bot,
+                nx,
+                ny,
+                options[i][0],
+                options[i][1],
+                depth - 1
+            );
+            bot_flip_cell(bot, nx, ny);
+            if (bot->aborted) {
+                break;
+            }
+            if (best_option < 0 || score > best) {
+                best = score;
+                best_option = i;
+            }
+        }
+        if (bot->aborted || best_option < 0) {
+            break;
+        }
+        *turn_vx = options[best_option][0];
+        *turn_vy = options[best_option][1];
+        bot->depth = depth;
+    }
+
+    return bot->depth;
+}
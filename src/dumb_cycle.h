@@ -0,0 +1,1015 @@
+#ifndef DUMB_CYCLE_H
+#define DUMB_CYCLE_H
+
+typedef unsigned char u8;
+typedef short i16;
+typedef unsigned short u16;
+typedef int i32;
+typedef unsigned int u32;
+typedef long i64;
+typedef unsigned long u64;
+
+enum board_layout {
+    BOARD_MIN_SIZE = 8,
+    BOARD_MAX_SIZE = 4096,
+};
+
+enum board_shape {
+    BOARD_SHAPE_ANY = 0,
+    BOARD_SHAPE_90X90,
+    BOARD_SHAPE_120X90,
+    BOARD_SHAPE_160X90,
+};
+
+enum bot_limits {
+    BOT_MAX_DEPTH = 16,
+};
+
+enum clock_id {
+    CLOCK_MONOTONIC = 1,
+};
+
+enum cpu_feature {
+    CPU_FEATURE_AVX2 = 1,
+};
+
+enum drm_event_type {
+    DRM_EVENT_TYPE_FLIP_COMPLETE = 2,
+};
+
+enum drm_ioctl {
+    DRM_IOCTL_MODE_GET_RESOURCES = 0xa0,
+    DRM_IOCTL_MODE_GET_CONNECTOR = 0xa7,
+    DRM_IOCTL_MODE_GET_ENCODER = 0xa6,
+    DRM_IOCTL_MODE_ADD_FB = 0xae,
+    DRM_IOCTL_MODE_CREATE_DUMB = 0xb2,
+    DRM_IOCTL_MODE_MAP_DUMB = 0xb3,
+    DRM_IOCTL_MODE_GET_CRTC = 0xa1,
+    DRM_IOCTL_MODE_SET_CRTC = 0xa2,
+    DRM_IOCTL_MODE_PAGE_FLIP = 0xb0,
+    DRM_IOCTL_MODE_DIRTYFB = 0xb1,
+};
+
+enum error_code {
+    ENOENT = 2,
+    EINTR = 4,
+    EAGAIN = 11,
+    EBUSY = 16,
+    EINVAL = 22,
+};
+
+enum ev_bits {
+    EV_SYN = 0x0,
+    EV_KEY = 0x1,
+    EV_MAX = 0x1f,
+};
+
+enum ev_ioctl {
+    EV_IOCTL_GET_BIT = 0x20,
+    EV_IOCTL_GET_KEY = 0x21,
+    EV_IOCTL_GRAB = 0x90,
+    EV_IOCTL_SET_CLOCK_ID = 0xa0,
+};
+
+enum ev_key_bits {
+    KEY_ESC = 1,
+    KEY_W = 17,
+    KEY_A = 30,
+    KEY_S = 31,
+    KEY_D = 32,
+    KEY_MAX = 0x2ff,
+};
+
+enum fake_drm_layout {
+    FAKE_DRM_CRTC_ID = 31,
+    FAKE_DRM_CONNECTOR_ID = 32,
+    FAKE_DRM_ENCODER_ID = 33,
+    FAKE_DRM_MAX_BUFFERS = 16,
+    FAKE_DRM_KEY_INTERVAL_NS = 250 * 1000 * 1000,
+};
+
+enum histogram_layout {
+    HISTOGRAM_SUB_BITS = 4,
+    HISTOGRAM_SUB_BUCKETS = 1 << HISTOGRAM_SUB_BITS,
+    HISTOGRAM_BUCKETS = (64 - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_BUCKETS,
+};
+
+enum ioctl_dir {
+    IOCTL_WRITE = 1,
+    IOCTL_READ = 2,
+    IOCTL_RDWR = 3,
+};
+
+enum ioctl_type {
+    IOCTL_EV = (i32)'E',
+    IOCTL_DRM = (i32)'d',
+};
+
+enum mmap_flag {
+    MAP_SHARED = 0x01,
+    MAP_PRIVATE = 0x02,
+    MAP_ANONYMOUS = 0x20,
+    MAP_POPULATE = 0x8000,
+    MAP_HUGETLB = 0x40000,
+};
+
+enum mmap_prot {
+    PROT_READ = 1,
+    PROT_WRITE = 2,
+};
+
+enum open_mode {
+    O_RDONLY = 0,
+    O_WRONLY = 1,
+    O_RDWR = 2,
+    O_CREAT = 0x40,
+    O_TRUNC = 0x200,
+};
+
+enum pixel_format {
+    PIXEL_FORMAT_XRGB8888 = 0,
+    PIXEL_FORMAT_RGB565,
+};
+
+enum poll_event {
+    POLLIN = 1,
+};
+
+enum render_mode {
+    RENDER_MODE_SPAN = 0,
+    RENDER_MODE_STREAM,
+    RENDER_MODE_EXPAND,
+};
+
+enum std_fd {
+    STDIN = 0,
+    STDOUT = 1,
+    STDERR = 2,
+};
+
+enum syscall {
+    SYS_READ = 0,
+    SYS_WRITE = 1,
+    SYS_OPEN = 2,
+    SYS_CLOSE = 3,
+    SYS_POLL = 7,
+    SYS_MMAP = 9,
+    SYS_MUNMAP = 11,
+    SYS_RT_SIGPROCMASK = 14,
+    SYS_IOCTL = 16,
+    SYS_MADVISE = 28,
+    SYS_GETPID = 39,
+    SYS_EXIT = 60,
+    SYS_GETDENTS = 78,
+    SYS_PRCTL = 157,
+    SYS_SCHED_GETAFFINITY = 204,
+    SYS_CLOCK_GETTIME = 228,
+    SYS_EXIT_GROUP = 231,
+    SYS_EPOLL_WAIT = 232,
+    SYS_EPOLL_CTL = 233,
+    SYS_OPENAT = 257,
+    SYS_TIMERFD_CREATE = 283,
+    SYS_TIMERFD_SETTIME = 286,
+    SYS_SIGNALFD4 = 289,
+    SYS_EPOLL_CREATE1 = 291,
+    SYS_IO_URING_SETUP = 425,
+    SYS_IO_URING_ENTER = 426,
+};
+
+enum syscall_stats_layout {
+    SYSCALL_STATS_SYSCALLS = 512,
+    SYSCALL_STATS_IOCTLS = 64,
+};
+
+enum timerfd_flag {
+    TFD_TIMER_ABSTIME = 1,
+};
+
+enum turn_queue_layout {
+    TURN_QUEUE_SIZE = 16,
+};
+
+struct band_pool;
+struct band_worker;
+struct io_uring_cqe;
+struct io_uring_params;
+struct io_uring_sqe;
+struct mcts_job;
+struct mcts_node;
+struct mcts_worker;
+
+struct pollfd {
+    i32 fd;
+    i16 events;
+    i16 revents;
+};
+
+struct dirent {
+    u64 ino;
+    u64 off;
+    u16 reclen;
+    char name[];
+};
+
+struct timespec {
+    i64 sec;
+    i64 nsec;
+};
+
+struct itimerspec {
+    struct timespec interval;
+    struct timespec value;
+};
+
+struct epoll_event {
+    u32 events;
+    u64 data;
+} __attribute__((packed));
+
+struct thread {
+    u32 tid;
+};
+
+struct arena {
+    char *start;
+    char *end;
+    char *base;
+    char *high;
+    u64 failures;
+};
+
+struct arena_checkpoint {
+    char *start;
+};
+
+struct syscall_layer {
+    u64 (*call)(void *ctx, u64 scid, u64 *args);
+    void *ctx;
+};
+
+struct syscall_counter {
+    u64 key;
+    u64 calls;
+    u64 cycles;
+};
+
+struct syscall_stats {
+    struct syscall_counter syscalls[SYSCALL_STATS_SYSCALLS];
+    struct syscall_counter ioctls[SYSCALL_STATS_IOCTLS];
+    u64 start_cycles;
+    i64 start_ns;
+    u64 ns_scale;
+};
+
+struct fake_drm_buffer {
+    u32 width;
+    u32 height;
+    u32 pitch;
+    u64 size;
+};
+
+struct fake_drm {
+    struct syscall_layer layer;
+    u32 width;
+    u32 height;
+    u32 refresh_hz;
+    i64 refresh_ns;
+    struct timespec start;
+
+    i32 card_fd;
+    i32 input_dir_fd;
+    i32 keyboard_fd;
+    i32 input_dir_listed;
+
+    u32 crtc_fb_id;
+    i32 flip_pending;
+    u32 flip_fb_id;
+    u64 flip_user_data;
+    i64 vblank_ns;
+    u64 flips;
+
+    u32 buffers_len;
+    struct fake_drm_buffer buffers[FAKE_DRM_MAX_BUFFERS];
+
+    char *keys;
+    i32 keys_len;
+    i32 key_index;
+    i64 key_interval_ns;
+};
+
+struct timeval {
+    i64 sec;
+    i64 usec;
+};
+
+struct input_event {
+    struct timeval time;
+    u16 type;
+    u16 code;
+    i32 value;
+};
+
+struct drm_mode_resources {
+    u32 *fbs;
+    u32 *crtcs;
+    u32 *connectors;
+    u32 *encoders;
+
+    u32 fbs_len;
+    u32 crtcs_len;
+    u32 connectors_len;
+    u32 encoders_len;
+
+    u32 min_width;
+    u32 max_width;
+    u32 min_height;
+    u32 max_height;
+};
+
+struct drm_mode_modeinfo {
+    u32 clock;
+
+    u16 hdisplay;
+    u16 hsync_start;
+    u16 hsync_end;
+    u16 htotal;
+    u16 hskew;
+
+    u16 vdisplay;
+    u16 vsync_start;
+    u16 vsync_end;
+    u16 vtotal;
+    u16 vscan;
+
+    u32 vrefresh;
+
+    u32 flags;
+    u32 type;
+    char name[32];
+};
+
+struct drm_mode_connector {
+    u32 *encoders;
+    struct drm_mode_modeinfo *modes;
+    u32 *props;
+    u64 *prop_values;
+
+    u32 modes_len;
+    u32 props_len;
+    u32 encoders_len;
+
+    u32 encoder_id;
+    u32 connector_id;
+
+    u32 connector_type;
+    u32 connector_type_id;
+    u32 connection;
+    u32 mm_width;
+    u32 mm_height;
+    u32 subpixel;
+    u32 pad;
+};
+
+struct drm_mode_encoder {
+    u32 encoder_id;
+    u32 encoder_type;
+
+    u32 crtc_id;
+
+    u32 possible_crtcs;
+    u32 possible_clones;
+};
+
+struct drm_mode_create_dumb {
+    u32 height;
+    u32 width;
+    u32 bpp;
+    u32 flags;
+    u32 handle;
+    u32 pitch;
+    u64 size;
+};
+
+struct drm_mode_map_dumb {
+    u32 handle;
+    u32 pad;
+    i64 offset;
+};
+
+struct drm_mode_fb_cmd {
+    u32 fb_id;
+    u32 width;
+    u32 height;
+    u32 pitch;
+    u32 bpp;
+    u32 depth;
+    u32 handle;
+};
+
+struct drm_mode_dumb_buffer {
+    u32 width;
+    u32 height;
+    u32 stride;
+    u32 handle;
+    u32 fb_id;
+    u32 *map;
+    u64 size;
+};
+
+struct drm_mode_crtc {
+    u32 *set_connectors;
+    u32 connectors_len;
+
+    u32 crtc_id;
+    u32 fb_id;
+
+    u32 x;
+    u32 y;
+
+    u32 gamma_size;
+    u32 mode_valid;
+    struct drm_mode_modeinfo mode;
+};
+
+struct drm_mode_crtc_page_flip {
+    u32 crtc_id;
+    u32 fb_id;
+    u32 flags;
+    u32 reserved;
+    void *user_data;
+};
+
+struct drm_clip_rect {
+    u16 x1;
+    u16 y1;
+    u16 x2;
+    u16 y2;
+};
+
+struct drm_mode_fb_dirty_cmd {
+    u32 fb_id;
+    u32 flags;
+    u32 color;
+    u32 num_clips;
+    u64 clips_ptr;
+};
+
+struct drm_event {
+    u32 type;
+    u32 length;
+};
+
+struct drm_event_vblank {
+    struct drm_event base;
+    u64 user_data;
+    u32 tv_sec;
+    u32 tv_usec;
+    u32 sequence;
+    u32 crtc_id;
+};
+
+struct game_state {
+    i32 x;
+    i32 y;
+    i32 vx;
+    i32 vy;
+    i32 nvx;
+    i32 nvy;
+    i32 nnvx;
+    i32 nnvy;
+    i32 dead;
+    i64 steps;
+    i64 timestep;
+    u32 epoch;
+    enum board_shape shape;
+    i32 width;
+    i32 height;
+    i32 row_words;
+    u64 *board;
+};
+
+struct queued_turn {
+    i64 press_ns;
+    i32 vx;
+    i32 vy;
+};
+
+struct turn_queue {
+    u32 head;
+    u32 tail;
+    struct queued_turn turns[TURN_QUEUE_SIZE];
+};
+
+struct renderer {
+    enum render_mode mode;
+    enum pixel_format format;
+    u32 x;
+    u32 y;
+    u32 scale;
+    u32 pixel_shift;
+    u32 cell_words;
+    u32 scanline_words;
+    u32 palette[2];
+    u32 *scanline;
+    void (*fill)(u32 *dst, u64 len, u32 value);
+    void (*copy)(u32 *dst, u32 *src, u64 len);
+    void (*stream)(u32 *dst, u32 *src, u64 len);
+    void (*expand)(
+        u32 *dst,
+        u64 *cells,
+        u64 len,
+        u64 cell_words,
+        u32 *palette
+    );
+    struct band_pool *bands;
+};
+
+struct board_damage {
+    i32 valid;
+    u32 epoch;
+    i32 partial_cell;
+    u64 *board;
+    i32 clips_full;
+    i32 clips_len;
+    struct drm_clip_rect *clips;
+};
+
+struct band_pool {
+    struct renderer *renderer;
+    i32 workers_len;
+    struct band_worker *workers;
+    struct drm_mode_dumb_buffer *buf;
+    struct game_state *state;
+    u32 generation;
+    u32 done;
+    u32 quit;
+};
+
+struct print_buffer {
+    i32 fd;
+    i64 len;
+    char bytes[4096];
+};
+
+struct histogram {
+    u64 count;
+    u64 sum;
+    u64 min;
+    u64 max;
+    u32 counts[HISTOGRAM_BUCKETS];
+};
+
+struct bot_head {
+    i32 x;
+    i32 y;
+};
+
+struct bot_fill {
+    u64 *visited;
+    u64 *front;
+    u64 *next;
+    i32 lo;
+    i32 hi;
+    i32 grow_lo;
+    i32 grow_hi;
+    i32 dirty_lo;
+    i32 dirty_hi;
+};
+
+struct bot {
+    i64 budget_ns;
+    i32 max_depth;
+    i64 deadline_ns;
+    i32 aborted;
+    i32 depth;
+    i64 nodes;
+    i32 width;
+    i32 height;
+    i32 row_words;
+    u64 last_mask;
+    u64 *board;
+    struct bot_fill mine;
+    struct bot_fill theirs;
+    struct bot_head *opponents;
+    i32 opponents_len;
+};
+
+struct mcts {
+    i64 budget_ns;
+    i32 width;
+    i32 height;
+    i32 row_words;
+    u64 *board;
+    u64 *select_board;
+    struct arena pools[2];
+    i32 pool;
+    struct mcts_node *root;
+    i32 workers_len;
+    struct mcts_worker *workers;
+    struct mcts_job *jobs;
+    i32 jobs_len;
+    u32 generation;
+    u32 done;
+    u32 quit;
+    u64 rollouts;
+};
+
+struct replay_header {
+    u32 magic;
+    u32 version;
+    i32 width;
+    i32 height;
+    i32 x;
+    i32 y;
+    i32 vx;
+    i32 vy;
+    i64 timestep;
+};
+
+struct replay_writer {
+    i32 fd;
+    i32 len;
+    u32 records[1024];
+};
+
+struct replay {
+    struct replay_header header;
+    u32 *records;
+    i64 records_len;
+    i64 next;
+    u32 ticks;
+};
+
+struct uring {
+    i32 fd;
+    u32 *sq_head;
+    u32 *sq_tail;
+    u32 sq_mask;
+    u32 sq_entries;
+    struct io_uring_sqe *sqes;
+    u32 *cq_head;
+    u32 *cq_tail;
+    u32 cq_mask;
+    struct io_uring_cqe *cqes;
+};
+
+struct uring_completion {
+    u64 user_data;
+    i32 res;
+};
+
+struct match {
+    i32 width;
+    i32 height;
+    i32 row_words;
+    i32 cycles_len;
+    i32 alive_len;
+    u32 generation;
+    u64 *board;
+    u32 *claims;
+    i32 *claim_owners;
+    i32 *alive;
+    i32 *x;
+    i32 *y;
+    i32 *vx;
+    i32 *vy;
+    i32 *nvx;
+    i32 *nvy;
+    i32 *nnvx;
+    i32 *nnvy;
+    char *dead;
+};
+
+u64 syscall0(u64 scid);
+u64 syscall1(u64 scid, u64 a1);
+u64 syscall2(u64 scid, u64 a1, u64 a2);
+u64 syscall3(u64 scid, u64 a1, u64 a2, u64 a3);
+u64 syscall4(u64 scid, u64 a1, u64 a2, u64 a3, u64 a4);
+u64 syscall5(u64 scid, u64 a1, u64 a2, u64 a3, u64 a4, u64 a5);
+u64 syscall6(u64 scid, u64 a1, u64 a2, u64 a3, u64 a4, u64 a5, u64 a6);
+u64 cycle_count(void);
+
+i64 clone_thread(
+    u64 flags,
+    char *stack,
+    u32 *parent_tid,
+    u32 *child_tid,
+    void (*start)(void *),
+    void *arg
+);
+
+i32 futex_wait(u32 *addr, u32 value);
+i32 futex_wake(u32 *addr, i32 count);
+
+void *memset(void *dst, i32 value, u64 len);
+void *memcpy(void *dst, void *src, u64 len);
+void *memset_avx2(void *dst, i32 value, u64 len);
+void *memcpy_avx2(void *dst, void *src, u64 len);
+void *memset_stream(void *dst, i32 value, u64 len);
+void *memcpy_stream(void *dst, void *src, u64 len);
+void fill32_rep(u32 *dst, u64 len, u32 value);
+
+u32 cpu_features(void);
+void fill32_sse2(u32 *dst, u64 len, u32 value);
+void fill32_avx2(u32 *dst, u64 len, u32 value);
+void copy32_sse2(u32 *dst, u32 *src, u64 len);
+void copy32_avx2(u32 *dst, u32 *src, u64 len);
+void stream32_sse2(u32 *dst, u32 *src, u64 len);
+void stream32_avx2(u32 *dst, u32 *src, u64 len);
+
+void expand32_sse2(
+    u32 *dst,
+    u64 *cells,
+    u64 len,
+    u64 cell_words,
+    u32 *palette
+);
+
+void expand32_avx2(
+    u32 *dst,
+    u64 *cells,
+    u64 len,
+    u64 cell_words,
+    u32 *palette
+);
+
+void arena_init(struct arena *arena, char *mem, i64 size);
+void *alloc_uninit(struct arena *arena, i64 size);
+void *alloc(struct arena *arena, i64 size);
+i32 arena_split(struct arena *arena, struct arena *sub, i64 size);
+struct arena_checkpoint arena_save(struct arena *arena);
+void arena_restore(struct arena *arena, struct arena_checkpoint checkpoint);
+void arena_reset(struct arena *arena);
+
+void syscall_layer_set(struct syscall_layer *layer);
+i64 read(i32 fd, char *bytes, i64 bytes_len);
+i64 write(i32 fd, char *bytes, i64 bytes_len);
+i32 open(char *fname, i32 mode, i32 flags);
+i32 close(i32 fd);
+i32 poll(struct pollfd *fds, i64 fds_len, i32 time_ms);
+void *mmap(void *hint, i64 size, i32 prot, i32 flags, i32 fd, i64 offset);
+i32 munmap(void *addr, i64 size);
+i32 madvise(void *addr, i64 size, i32 advice);
+i32 ioctl(i32 fd, u32 dir, u32 type, u32 number, u32 size, char *arg);
+void exit(i32 error_code);
+i64 getdents(i32 fd, struct dirent *dents, i64 dents_size);
+i32 clock_gettime(i32 clock_id, struct timespec *timespec);
+i64 time_since_ns(struct timespec *end, struct timespec *start);
+void syscall_stats_enable(struct syscall_stats *stats);
+void syscall_stats_disable(void);
+void syscall_stats_calibrate(struct syscall_stats *stats);
+i32 timerfd_create(i32 clock_id, i32 flags);
+i32 timerfd_settime(i32 fd, i32 flags, struct itimerspec *value);
+i32 openat(i32 dfd, char *fname, i32 mode, i32 flags);
+i32 rt_sigprocmask(i32 how, u64 *set, u64 *old_set);
+i32 signalfd(i32 fd, u64 *mask, i32 flags);
+i32 epoll_create1(i32 flags);
+i32 epoll_ctl(i32 epfd, i32 op, i32 fd, struct epoll_event *event);
+
+i32 epoll_wait(
+    i32 epfd,
+    struct epoll_event *events,
+    i32 events_len,
+    i32 time_ms
+);
+
+i32 prctl(i32 option, u64 arg);
+i32 cpu_count(void);
+
+i32 thread_create(
+    struct thread *thread,
+    char *stack,
+    i64 stack_size,
+    void (*start)(void *),
+    void *arg
+);
+
+void thread_join(struct thread *thread);
+i32 io_uring_setup(u32 entries, struct io_uring_params *params);
+i32 io_uring_enter(i32 fd, u32 to_submit, u32 min_complete, u32 flags);
+
+void print_flush(struct print_buffer *out);
+void print_char(struct print_buffer *out, char c);
+void print_str(struct print_buffer *out, char *s);
+void print_u64(struct print_buffer *out, u64 value);
+void print_i64(struct print_buffer *out, i64 value);
+
+void histogram_clear(struct histogram *histogram);
+void histogram_record(struct histogram *histogram, u64 value);
+void histogram_merge(struct histogram *histogram, struct histogram *other);
+
+void histogram_print(
+    struct print_buffer *out,
+    char *name,
+    char *unit,
+    struct histogram *histogram
+);
+
+u64 *board_row(struct game_state *state, i32 y);
+i32 board_test(u64 *row, i32 x);
+void board_set(u64 *row, i32 x);
+
+i32 game_init(
+    struct game_state *state,
+    struct arena *arena,
+    i32 width,
+    i32 height
+);
+
+void clear_game(struct game_state *state);
+void update_game(struct game_state *state);
+i32 queue_turn(struct game_state *state, i32 vx, i32 vy);
+void turn_queue_clear(struct turn_queue *queue);
+i32 turn_queue_push(struct turn_queue *queue, i64 press_ns, i32 vx, i32 vy);
+
+i64 turn_queue_apply(
+    struct turn_queue *queue,
+    struct game_state *state,
+    i64 tick_ns
+);
+
+i32 renderer_init(
+    struct renderer *renderer,
+    struct arena *arena,
+    enum render_mode mode,
+    enum pixel_format format,
+    u32 width,
+    u32 height,
+    struct game_state *state
+);
+
+void draw_game_rows(
+    struct renderer *renderer,
+    struct drm_mode_dumb_buffer *buf,
+    struct game_state *state,
+    u32 *scanline,
+    u32 row_start,
+    u32 row_end
+);
+
+void draw_game(
+    struct renderer *renderer,
+    struct drm_mode_dumb_buffer *buf,
+    struct game_state *state
+);
+
+i32 draw_partial(
+    struct renderer *renderer,
+    struct drm_mode_dumb_buffer *buf,
+    struct game_state *state,
+    u32 partial
+);
+
+i32 board_damage_init(
+    struct board_damage *damage,
+    struct arena *arena,
+    struct game_state *state
+);
+
+void board_damage_merge(struct board_damage *dst, struct board_damage *src);
+
+void copy_damage(
+    struct renderer *renderer,
+    struct drm_mode_dumb_buffer *dst,
+    struct drm_mode_dumb_buffer *src,
+    struct board_damage *damage
+);
+
+void board_damage_submitted(struct board_damage *damage);
+
+void draw_damage(
+    struct renderer *renderer,
+    struct drm_mode_dumb_buffer *buf,
+    struct board_damage *damage,
+    struct game_state *state
+);
+
+void draw_partial_damage(
+    struct renderer *renderer,
+    struct drm_mode_dumb_buffer *buf,
+    struct board_damage *damage,
+    struct game_state *state,
+    u32 partial
+);
+
+i32 band_pool_init(
+    struct band_pool *pool,
+    struct arena *arena,
+    struct renderer *renderer,
+    i32 workers_len
+);
+
+void band_pool_stop(struct band_pool *pool);
+
+void band_pool_draw(
+    struct band_pool *pool,
+    struct drm_mode_dumb_buffer *buf,
+    struct game_state *state
+);
+
+i32 bot_init(
+    struct bot *bot,
+    struct arena *arena,
+    i32 width,
+    i32 height,
+    i64 budget_ns,
+    i32 max_depth
+);
+
+i32 bot_choose(
+    struct bot *bot,
+    u64 *board,
+    i32 x,
+    i32 y,
+    i32 vx,
+    i32 vy,
+    struct bot_head *opponents,
+    i32 opponents_len,
+    i32 *turn_vx,
+    i32 *turn_vy
+);
+
+i32 mcts_init(
+    struct mcts *mcts,
+    struct arena *arena,
+    i32 width,
+    i32 height,
+    i64 budget_ns,
+    i32 workers_len,
+    i64 pool_size
+);
+
+void mcts_stop(struct mcts *mcts);
+
+u64 mcts_choose(
+    struct mcts *mcts,
+    u64 *board,
+    i32 x,
+    i32 y,
+    i32 vx,
+    i32 vy,
+    i32 *turn_vx,
+    i32 *turn_vy
+);
+
+i32 match_init(
+    struct match *match,
+    struct arena *arena,
+    i32 width,
+    i32 height,
+    i32 cycles_len
+);
+
+void match_reset(struct match *match);
+i32 match_cell_free(struct match *match, i32 x, i32 y);
+i32 match_turn(struct match *match, i32 cycle, i32 vx, i32 vy);
+i32 match_update(struct match *match);
+
+i32 replay_writer_open(
+    struct replay_writer *writer,
+    char *path,
+    struct replay_header *header
+);
+
+i32 replay_writer_turn(
+    struct replay_writer *writer,
+    u32 tick,
+    i32 vx,
+    i32 vy
+);
+
+i32 replay_writer_close(struct replay_writer *writer, u32 ticks);
+i32 replay_load(struct replay *replay, struct arena *arena, char *path);
+i32 replay_turn(struct replay *replay, u32 tick, i32 *vx, i32 *vy);
+
+i32 uring_init(struct uring *ring, u32 entries);
+
+i32 uring_read(
+    struct uring *ring,
+    i32 fd,
+    char *bytes,
+    u32 len,
+    u64 user_data
+);
+
+i32 uring_poll(struct uring *ring, i32 fd, u32 events, u64 user_data);
+i32 uring_timeout(struct uring *ring, struct timespec *when, u64 user_data);
+i32 uring_timeout_remove(struct uring *ring, u64 target, u64 user_data);
+i32 uring_submit(struct uring *ring, u32 min_complete);
+
+i32 uring_harvest(
+    struct uring *ring,
+    struct uring_completion *completions,
+    i32 completions_len
+);
+
+i32 fake_drm_init(
+    struct fake_drm *fake,
+    u32 width,
+    u32 height,
+    u32 refresh_hz,
+    char *keys,
+    i64 key_interval_ns
+);
+
+#endif
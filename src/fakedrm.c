@@ -0,0 +1,505 @@
+#include "dumb_cycle.h"
+
+static u64 fake_error(i32 error) {
+    return (u64)-(i64)error;
+}
+
+static i32 fake_str_equal(char *a, char *b) {
+    while (*a != 0 && *a == *b) {
+        a += 1;
+        b += 1;
+    }
+    return *a == *b;
+}
+
+static void fake_set_bit(char *bytes, u32 len, i32 bit_num) {
+    u32 byte_index = (u32)bit_num / 8;
+    if (byte_index < len) {
+        bytes[byte_index] = (char)(bytes[byte_index] | (1 << (bit_num % 8)));
+    }
+}
+
+static i64 fake_now_ns(void) {
+    struct timespec now;
+    syscall6(SYS_CLOCK_GETTIME, CLOCK_MONOTONIC, (u64)&now, 0, 0, 0, 0);
+    return now.sec * 1000L * 1000L * 1000L + now.nsec;
+}
+
+static i32 fake_key_code(char key) {
+    switch (key) {
+        case 'w':
+            return KEY_W;
+        case 'a':
+            return KEY_A;
+        case 's':
+            return KEY_S;
+        case 'd':
+            return KEY_D;
+        case 'q':
+            return KEY_ESC;
+        default:
+            return -1;
+    }
+}
+
+static void fake_drm_mode(
+    struct fake_drm *fake,
+    struct drm_mode_modeinfo *mode
+) {
+    memset(mode, 0, sizeof(*mode));
+    mode->hdisplay = (u16)fake->width;
+    mode->vdisplay = (u16)fake->height;
+    mode->htotal = (u16)fake->width;
+    mode->vtotal = (u16)fake->height;
+    mode->vrefresh = fake->refresh_hz;
+    mode->clock = fake->width * fake->height / 1000 * fake->refresh_hz;
+    mode->name[0] = 'f';
+    mode->name[1] = 'a';
+    mode->name[2] = 'k';
+    mode->name[3] = 'e';
+}
+
+static struct fake_drm_buffer *fake_drm_buffer(
+    struct fake_drm *fake,
+    u32 handle
+) {
+    if (handle == 0 || handle > fake->buffers_len) {
+        return 0;
+    }
+    return &fake->buffers[handle - 1];
+}
+
+static u64 fake_drm_page_flip(
+    struct fake_drm *fake,
+    struct drm_mode_crtc_page_flip *flip
+) {
+    if (
+        flip->crtc_id != FAKE_DRM_CRTC_ID ||
+        fake_drm_buffer(fake, flip->fb_id) == 0
+    ) {
+        return fake_error(EINVAL);
+    }
+    if (fake->flip_pending) {
+        return fake_error(EBUSY);
+    }
+
+    i64 start_ns = fake->start.sec * 1000L * 1000L * 1000L + fake->start.nsec;
+    i64 since_start = fake_now_ns() - start_ns;
+    i64 vblank = (since_start / fake->refresh_ns + 1) * fake->refresh_ns;
+    i64 deadline = start_ns + vblank;
+    struct itimerspec timer = {
+        .value = {
+            .sec = deadline / (1000L * 1000L * 1000L),
+            .nsec = deadline % (1000L * 1000L * 1000L),
+        },
+    };
+    u64 return_value = syscall6(
+        SYS_TIMERFD_SETTIME,
+        (u64)fake->card_fd,
+        TFD_TIMER_ABSTIME,
+        (u64)&timer,
+        0,
+        0,
+        0
+    );
+    if (return_value != 0) {
+        return return_value;
+    }
+
+    fake->vblank_ns = vblank;
+    fake->flip_fb_id = flip->fb_id;
+    fake->flip_user_data = (u64)flip->user_data;
+    fake->flip_pending = 1;
+    return 0;
+}
+
+static u64 fake_drm_card_ioctl(struct fake_drm *fake, u32 number, char *arg) {
+    switch (number) {
+        case DRM_IOCTL_MODE_GET_RESOURCES: {
+            struct drm_mode_resources *res = (void *)arg;
+            if (res->crtcs_len >= 1 && res->crtcs != 0) {
+                res->crtcs[0] = FAKE_DRM_CRTC_ID;
+            }
+            if (res->connectors_len >= 1 && res->connectors != 0) {
+                res->connectors[0] = FAKE_DRM_CONNECTOR_ID;
+            }
+            if (res->encoders_len >= 1 && res->encoders != 0) {
+                res->encoders[0] = FAKE_DRM_ENCODER_ID;
+            }
+            res->fbs_len = 0;
+            res->crtcs_len = 1;
+            res->connectors_len = 1;
+            res->encoders_len = 1;
+            res->min_width = 1;
+            res->max_width = fake->width;
+            res->min_height = 1;
+            res->max_height = fake->height;
+            return 0;
+        }
+        case DRM_IOCTL_MODE_GET_CONNECTOR: {
+            struct drm_mode_connector *conn = (void *)arg;
+            if (conn->connector_id != FAKE_DRM_CONNECTOR_ID) {
+                return fake_error(ENOENT);
+            }
+            if (conn->modes_len >= 1 && conn->modes != 0) {
+                fake_drm_mode(fake, &conn->modes[0]);
+            }
+            if (conn->encoders_len >= 1 && conn->encoders != 0) {
+                conn->encoders[0] = FAKE_DRM_ENCODER_ID;
+            }
+            conn->modes_len = 1;
+            conn->props_len = 0;
+            conn->encoders_len = 1;
+            conn->encoder_id = FAKE_DRM_ENCODER_ID;
+            conn->connection = 1;
+            return 0;
+        }
+        case DRM_IOCTL_MODE_GET_ENCODER: {
+            struct drm_mode_encoder *enc = (void *)arg;
+            if (enc->encoder_id != FAKE_DRM_ENCODER_ID) {
+                return fake_error(ENOENT);
+            }
+            enc->crtc_id = FAKE_DRM_CRTC_ID;
+            enc->possible_crtcs = 1;
+            return 0;
+        }
+        case DRM_IOCTL_MODE_GET_CRTC: {
+            struct drm_mode_crtc *crtc = (void *)arg;
+            if (crtc->crtc_id != FAKE_DRM_CRTC_ID) {
+                return fake_error(ENOENT);
+            }
+            crtc->fb_id = fake->crtc_fb_id;
+            crtc->mode_valid = 1;
+            fake_drm_mode(fake, &crtc->mode);
+            return 0;
+        }
+        case DRM_IOCTL_MODE_SET_CRTC: {
+            struct drm_mode_crtc *crtc = (void *)arg;
+            if (
+                crtc->crtc_id != FAKE_DRM_CRTC_ID ||
+                fake_drm_buffer(fake, crtc->fb_id) == 0
+            ) {
+                return fake_error(EINVAL);
+            }
+            fake->crtc_fb_id = crtc->fb_id;
+            return 0;
+        }
+        case DRM_IOCTL_MODE_CREATE_DUMB: {
+            struct drm_mode_create_dumb *creq = (void *)arg;
+            if (fake->buffers_len == FAKE_DRM_MAX_BUFFERS) {
+                return fake_error(EINVAL);
+            }
+            struct fake_drm_buffer *buf = &fake->buffers[fake->buffers_len];
+            buf->width = creq->width;
+            buf->height = creq->height;
+            buf->pitch = (creq->width * creq->bpp / 8 + 63) & ~63U;
+            buf->size = (u64)buf->pitch * creq->height;
+            fake->buffers_len += 1;
+            creq->handle = fake->buffers_len;
+            creq->pitch = buf->pitch;
+            creq->size = buf->size;
+            return 0;
+        }
+        case DRM_IOCTL_MODE_ADD_FB: {
+            struct drm_mode_fb_cmd *fb_cmd = (void *)arg;
+            if (fake_drm_buffer(fake, fb_cmd->handle) == 0) {
+                return fake_error(EINVAL);
+            }
+            fb_cmd->fb_id = fb_cmd->handle;
+            return 0;
+        }
+        case DRM_IOCTL_MODE_MAP_DUMB: {
+            struct drm_mode_map_dumb *mreq = (void *)arg;
+            if (fake_drm_buffer(fake, mreq->handle) == 0) {
+                return fake_error(EINVAL);
+            }
+            mreq->offset = (i64)mreq->handle << 12;
+            return 0;
+        }
+        case DRM_IOCTL_MODE_PAGE_FLIP:
+            return fake_drm_page_flip(fake, (void *)arg);
+        case DRM_IOCTL_MODE_DIRTYFB: {
+            struct drm_mode_fb_dirty_cmd *dirty = (void *)arg;
+            if (fake_drm_buffer(fake, dirty->fb_id) == 0) {
+                return fake_error(EINVAL);
+            }
+            return 0;
+        }
+        default:
+            return fake_error(EINVAL);
+    }
+}
+
+static u64 fake_drm_keyboard_ioctl(u32 number, u32 size, char *arg) {
+    switch (number) {
+        case EV_IOCTL_GET_BIT:
+            memset(arg, 0, size);
+            fake_set_bit(arg, size, EV_KEY);
+            return 0;
+        case EV_IOCTL_GET_KEY:
+            memset(arg, 0, size);
+            fake_set_bit(arg, size, KEY_ESC);
+            fake_set_bit(arg, size, KEY_W);
+            fake_set_bit(arg, size, KEY_A);
+            fake_set_bit(arg, size, KEY_S);
+            fake_set_bit(arg, size, KEY_D);
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+static u64 fake_drm_read_card(struct fake_drm *fake, char *bytes, u64 len) {
+    u64 expirations;
+    u64 return_value = syscall6(
+        SYS_READ,
+        (u64)fake->card_fd,
+        (u64)&expirations,
+        sizeof(expirations),
+        0,
+        0,
+        0
+    );
+    if (return_value != sizeof(expirations)) {
+        return return_value;
+    }
+    if (!fake->flip_pending || len < sizeof(struct drm_event_vblank)) {
+        return 0;
+    }
+
+    i64 time_ns = fake->start.sec * 1000L * 1000L * 1000L +
+        fake->start.nsec + fake->vblank_ns;
+    struct drm_event_vblank *vblank = (void *)bytes;
+    vblank->base.type = DRM_EVENT_TYPE_FLIP_COMPLETE;
+    vblank->base.length = sizeof(*vblank);
+    vblank->user_data = fake->flip_user_data;
+    vblank->tv_sec = (u32)(time_ns / (1000L * 1000L * 1000L));
+    vblank->tv_usec = (u32)(time_ns % (1000L * 1000L * 1000L) / 1000L);
+    vblank->sequence = (u32)(fake->vblank_ns / fake->refresh_ns);
+    vblank->crtc_id = FAKE_DRM_CRTC_ID;
+
+    fake->crtc_fb_id = fake->flip_fb_id;
+    fake->flip_pending = 0;
+    fake->flips += 1;
+    return sizeof(*vblank);
+}
+
+static u64 fake_drm_read_keyboard(
+    struct fake_drm *fake,
+    char *bytes,
+    u64 len
+) {
+    u64 expirations;
+    u64 return_value = syscall6(
+        SYS_READ,
+        (u64)fake->keyboard_fd,
+        (u64)&expirations,
+        sizeof(expirations),
+        0,
+        0,
+        0
+    );
+    if (return_value != sizeof(expirations)) {
+        return return_value;
+    }
+    if (len < 2 * sizeof(struct input_event)) {
+        return fake_error(EINVAL);
+    }
+
+    i64 now_ns = fake_now_ns();
+    struct input_event *events = (void *)bytes;
+    memset(bytes, 0, 2 * sizeof(*events));
+    events[0].time.sec = now_ns / (1000L * 1000L * 1000L);
+    events[0].time.usec = now_ns % (1000L * 1000L * 1000L) / 1000L;
+    events[0].type = EV_KEY;
+    events[0].code = (u16)fake_key_code(fake->keys[fake->key_index]);
+    events[0].value = 1;
+    events[1].time = events[0].time;
+    events[1].type = EV_SYN;
+    fake->key_index = (fake->key_index + 1) % fake->keys_len;
+    return 2 * sizeof(*events);
+}
+
+static u64 fake_drm_getdents(struct fake_drm *fake, char *bytes, u64 len) {
+    char name[] = "event0";
+    u16 reclen = (u16)((sizeof(struct dirent) + sizeof(name) + 1 + 7) & ~7UL);
+    if (fake->input_dir_listed) {
+        return 0;
+    }
+    if (len < reclen) {
+        return fake_error(EINVAL);
+    }
+
+    struct dirent *dent = (void *)bytes;
+    memset(bytes, 0, reclen);
+    dent->ino = 1;
+    dent->off = 1;
+    dent->reclen = reclen;
+    for (u64 i = 0; i < sizeof(name); ++i) {
+        dent->name[i] = name[i];
+    }
+    fake->input_dir_listed = 1;
+    return reclen;
+}
+
+static u64 fake_drm_call(void *ctx, u64 scid, u64 *args) {
+    struct fake_drm *fake = ctx;
+    i32 fd = (i32)args[0];
+    switch (scid) {
+        case SYS_OPEN:
+            if (fake_str_equal((char *)args[0], "/dev/dri/card0")) {
+                return (u64)fake->card_fd;
+            }
+            if (fake_str_equal((char *)args[0], "/dev/input")) {
+                fake->input_dir_listed = 0;
+                return (u64)fake->input_dir_fd;
+            }
+            break;
+        case SYS_OPENAT:
+            if (fd == fake->input_dir_fd) {
+                if (fake_str_equal((char *)args[1], "event0")) {
+                    return (u64)fake->keyboard_fd;
+                }
+                return fake_error(ENOENT);
+            }
+            break;
+        case SYS_CLOSE:
+            if (
+                fd == fake->card_fd ||
+                fd == fake->input_dir_fd ||
+                fd == fake->keyboard_fd
+            ) {
+                return 0;
+            }
+            break;
+        case SYS_GETDENTS:
+            if (fd == fake->input_dir_fd) {
+                return fake_drm_getdents(fake, (char *)args[1], args[2]);
+            }
+            break;
+        case SYS_IOCTL: {
+            u32 number = (u32)args[1] & 0xff;
+            u32 type = ((u32)args[1] >> 8) & 0xff;
+            u32 size = ((u32)args[1] >> 16) & 0x3fff;
+            if (fd == fake->card_fd && type == IOCTL_DRM) {
+                return fake_drm_card_ioctl(fake, number, (char *)args[2]);
+            }
+            if (fd == fake->keyboard_fd && type == IOCTL_EV) {
+                return fake_drm_keyboard_ioctl(number, size, (char *)args[2]);
+            }
+            if (fd == fake->card_fd || fd == fake->keyboard_fd) {
+                return fake_error(EINVAL);
+            }
+            break;
+        }
+        case SYS_MMAP:
+            if ((i32)args[4] == fake->card_fd) {
+                return syscall6(
+                    SYS_MMAP,
+                    args[0],
+                    args[1],
+                    PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS,
+                    (u64)-1L,
+                    0
+                );
+            }
+            break;
+        case SYS_READ:
+            if (fd == fake->card_fd) {
+                return fake_drm_read_card(fake, (char *)args[1], args[2]);
+            }
+            if (fd == fake->keyboard_fd) {
+                return fake_drm_read_keyboard(fake, (char *)args[1], args[2]);
+            }
+            break;
+        default:
+            break;
+    }
+    return syscall6(scid, args[0], args[1], args[2], args[3], args[4], args[5]);
+}
+
+static i32 fake_timerfd(void) {
+    u64 return_value = syscall6(
+        SYS_TIMERFD_CREATE,
+        CLOCK_MONOTONIC,
+        0,
+        0,
+        0,
+        0,
+        0
+    );
+    if (return_value > -4096UL) {
+        return -1;
+    }
+    return (i32)return_value;
+}
+
+i32 fake_drm_init(
+    struct fake_drm *fake,
+    u32 width,
+    u32 height,
+    u32 refresh_hz,
+    char *keys,
+    i64 key_interval_ns
+) {
+    fake->layer.call = fake_drm_call;
+    fake->layer.ctx = fake;
+    fake->width = width;
+    fake->height = height;
+    fake->refresh_hz = refresh_hz;
+    fake->refresh_ns = (1000L * 1000L * 1000L) / (i64)refresh_hz;
+    fake->crtc_fb_id = 0;
+    fake->flip_pending = 0;
+    fake->flips = 0;
+    fake->buffers_len = 0;
+    fake->keys = keys;
+    fake->keys_len = 0;
+    fake->key_index = 0;
+    fake->key_interval_ns = key_interval_ns;
+    while (keys[fake->keys_len] != 0) {
+        if (fake_key_code(keys[fake->keys_len]) < 0) {
+            return -1;
+        }
+        fake->keys_len += 1;
+    }
+    syscall6(
+        SYS_CLOCK_GETTIME,
+        CLOCK_MONOTONIC,
+        (u64)&fake->start,
+        0,
+        0,
+        0,
+        0
+    );
+
+    fake->card_fd = fake_timerfd();
+    fake->input_dir_fd = fake_timerfd();
+    fake->keyboard_fd = fake_timerfd();
+    if (fake->card_fd < 0 || fake->input_dir_fd < 0 || fake->keyboard_fd < 0) {
+        return -1;
+    }
+
+    if (fake->keys_len > 0) {
+        struct itimerspec timer = {
+            .interval = {
+                .sec = key_interval_ns / (1000L * 1000L * 1000L),
+                .nsec = key_interval_ns % (1000L * 1000L * 1000L),
+            },
+        };
+        timer.value = timer.interval;
+        u64 return_value = syscall6(
+            SYS_TIMERFD_SETTIME,
+            (u64)fake->keyboard_fd,
+            0,
+            (u64)&timer,
+            0,
+            0,
+            0
+        );
+        if (return_value != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,722 @@
+#include "dumb_cycle.h"
+
+enum color {
+    COLOR_BLUE = 0x0000ff,
+    COLOR_GRAY = 0xededed,
+};
+
+u64 *board_row(struct game_state *state, i32 y) {
+    return &state->board[y * state->row_words];
+}
+
+i32 board_test(u64 *row, i32 x) {
+    return (i32)((row[x / 64] >> (x % 64)) & 1);
+}
+
+void board_set(u64 *row, i32 x) {
+    row[x / 64] |= 1UL << (x % 64);
+}
+
+static u32 board_run_end(u64 *row, u32 start, u32 width) {
+    u64 value = 0 - ((row[start / 64] >> (start % 64)) & 1);
+    u32 word = start / 64;
+    u64 diff = (row[word] ^ value) & (~0UL << (start % 64));
+    while (diff == 0) {
+        word += 1;
+        if (word * 64 >= width) {
+            return width;
+        }
+        diff = row[word] ^ value;
+    }
+    u32 end = word * 64 + (u32)__builtin_ctzl(diff);
+    return (end < width) ? end : width;
+}
+
+i32 game_init(
+    struct game_state *state,
+    struct arena *arena,
+    i32 width,
+    i32 height
+) {
+    if (
+        width < BOARD_MIN_SIZE ||
+        width > BOARD_MAX_SIZE ||
+        height < BOARD_MIN_SIZE ||
+        height > BOARD_MAX_SIZE
+    ) {
+        return -1;
+    }
+
+    state->width = width;
+    state->height = height;
+    state->row_words = (width + 63) / 64;
+    state->board = alloc(
+        arena,
+        height * state->row_words * (i64)sizeof(u64)
+    );
+    if (state->board == 0) {
+        return -1;
+    }
+
+    state->shape = BOARD_SHAPE_ANY;
+    if (height == 90) {
+        if (width == 90) {
+            state->shape = BOARD_SHAPE_90X90;
+        } else if (width == 120) {
+            state->shape = BOARD_SHAPE_120X90;
+        } else if (width == 160) {
+            state->shape = BOARD_SHAPE_160X90;
+        }
+    }
+
+    state->epoch = 0;
+    return 0;
+}
+
+void clear_game(struct game_state *state) {
+    state->x = state->width / 6;
+    state->y = state->height / 2;
+    state->vx = 1;
+    state->vy = 0;
+    state->nvx = state->vx;
+    state->nvy = state->vy;
+    state->nnvx = state->vx;
+    state->nnvy = state->vy;
+    state->dead = 0;
+
+    state->timestep = 66L * 1000L * 1000L;
+    state->steps = 0;
+    state->epoch += 1;
+
+    memset(
+        state->board,
+        0,
+        (u64)(state->height * state->row_words) * sizeof(u64)
+    );
+    board_set(board_row(state, state->y), state->x);
+}
+
+static inline __attribute__((always_inline)) void update_board(
+    struct game_state *state,
+    i32 width,
+    i32 height,
+    i32 row_words
+) {
+    if (
+        state->x >= width ||
+        state->x < 0 ||
+        state->y >= height ||
+        state->y < 0
+    ) {
+        state->dead = 1;
+        return;
+    }
+    u64 *row = &state->board[state->y * row_words];
+    if (board_test(row, state->x)) {
+        state->dead = 1;
+    } else {
+        board_set(row, state->x);
+    }
+}
+
+void update_game(struct game_state *state) {
+    state->y += state->vy;
+    state->x += state->vx;
+    state->vx = state->nvx;
+    state->vy = state->nvy;
+    state->nvx = state->nnvx;
+    state->nvy = state->nnvy;
+
+    switch (state->shape) {
+        case BOARD_SHAPE_90X90:
+            update_board(state, 90, 90, 2);
+            break;
+        case BOARD_SHAPE_120X90:
+            update_board(state, 120, 90, 2);
+            break;
+        case BOARD_SHAPE_160X90:
+            update_board(state, 160, 90, 3);
+            break;
+        default:
+            update_board(state, state->width, state->height, state->row_words);
+            break;
+    }
+
+    state->steps += 1;
+    if (state->steps >= (1000L * 1000L * 1000L) / state->timestep) {
+        if (state->timestep > 16L * 1000L * 1000L) {
+            state->timestep -= 2L * 1000L * 1000L;
+        }
+        state->steps = 0;
+    }
+}
+
+i32 queue_turn(struct game_state *state, i32 vx, i32 vy) {
+    if (state->nvx == state->vx && state->nvy == state->vy) {
+        if (state->vx != -vx || state->vy != -vy) {
+            state->nvx = vx;
+            state->nvy = vy;
+            state->nnvx = vx;
+            state->nnvy = vy;
+            return 2;
+        }
+    } else if (state->nvx != -vx || state->nvy != -vy) {
+        state->nnvx = vx;
+        state->nnvy = vy;
+        return 1;
+    }
+    return 0;
+}
+
+void turn_queue_clear(struct turn_queue *queue) {
+    queue->head = 0;
+    queue->tail = 0;
+}
+
+i32 turn_queue_push(struct turn_queue *queue, i64 press_ns, i32 vx, i32 vy) {
+    if (queue->head - queue->tail >= TURN_QUEUE_SIZE) {
+        return 0;
+    }
+    struct queued_turn *turn = &queue->turns[queue->head % TURN_QUEUE_SIZE];
+    turn->press_ns = press_ns;
+    turn->vx = vx;
+    turn->vy = vy;
+    queue->head += 1;
+    return 1;
+}
+
+i64 turn_queue_apply(
+    struct turn_queue *queue,
+    struct game_state *state,
+    i64 tick_ns
+) {
+    while (queue->tail != queue->head) {
+        struct queued_turn *turn = &queue->turns[
+            queue->tail % TURN_QUEUE_SIZE
+        ];
+        if (turn->press_ns > tick_ns) {
+            break;
+        }
+        queue->tail += 1;
+        if (
+            (turn->vx == state->vx && turn->vy == state->vy) ||
+            (turn->vx == -state->vx && turn->vy == -state->vy)
+        ) {
+            continue;
+        }
+        state->nvx = turn->vx;
+        state->nvy = turn->vy;
+        state->nnvx = turn->vx;
+        state->nnvy = turn->vy;
+        return turn->press_ns;
+    }
+    return 0;
+}
+
+enum renderer_limits {
+    RENDERER_SCANLINE_SLACK = 8,
+};
+
+static u32 pack_color(enum pixel_format format, u32 color) {
+    if (format == PIXEL_FORMAT_RGB565) {
+        u32 r = (color >> 19) & 0x1f;
+        u32 g = (color >> 10) & 0x3f;
+        u32 b = (color >> 3) & 0x1f;
+        u32 pixel = (r << 11) | (g << 5) | b;
+        return pixel | (pixel << 16);
+    }
+    return color;
+}
+
+i32 renderer_init(
+    struct renderer *renderer,
+    struct arena *arena,
+    enum render_mode mode,
+    enum pixel_format format,
+    u32 width,
+    u32 height,
+    struct game_state *state
+) {
+    u32 board_width = (u32)state->width;
+    u32 board_height = (u32)state->height;
+    renderer->mode = mode;
+    renderer->format = format;
+    renderer->pixel_shift = 0;
+    if (format == PIXEL_FORMAT_RGB565) {
+        renderer->pixel_shift = 1;
+    }
+    u32 pixel_mask = (1U << renderer->pixel_shift) - 1;
+    renderer->scale = width / board_width;
+    if (height / board_height < renderer->scale) {
+        renderer->scale = height / board_height;
+    }
+    renderer->scale &= ~pixel_mask;
+    if (renderer->scale == 0) {
+        return -1;
+    }
+    renderer->x = ((width - board_width * renderer->scale) / 2) & ~pixel_mask;
+    renderer->y = (height - board_height * renderer->scale) / 2;
+    renderer->cell_words = renderer->scale >> renderer->pixel_shift;
+    renderer->scanline_words = board_width * renderer->cell_words;
+    renderer->palette[0] = pack_color(format, (u32)COLOR_GRAY);
+    renderer->palette[1] = pack_color(format, (u32)COLOR_BLUE);
+
+    renderer->scanline = 0;
+    renderer->bands = 0;
+    if (mode == RENDER_MODE_EXPAND) {
+        renderer->scanline_words += RENDERER_SCANLINE_SLACK;
+    }
+    if (mode != RENDER_MODE_SPAN) {
+        renderer->scanline = alloc(
+            arena,
+            renderer->scanline_words * sizeof(u32)
+        );
+        if (renderer->scanline == 0) {
+            return -1;
+        }
+    }
+
+    if ((cpu_features() & CPU_FEATURE_AVX2) != 0) {
+        renderer->fill = fill32_avx2;
+        renderer->copy = copy32_avx2;
+        renderer->stream = stream32_avx2;
+        renderer->expand = expand32_avx2;
+    } else {
+        renderer->fill = fill32_sse2;
+        renderer->copy = copy32_sse2;
+        renderer->stream = stream32_sse2;
+        renderer->expand = expand32_sse2;
+    }
+
+    return 0;
+}
+
+static u32 cell_color(struct renderer *renderer, i32 cell) {
+    return renderer->palette[cell != 0];
+}
+
+static inline __attribute__((always_inline)) void draw_board(
+    struct renderer *renderer,
+    struct drm_mode_dumb_buffer *buf,
+    struct game_state *state,
+    u32 *scanline,
+    u32 width,
+    u32 row_start,
+    u32 row_end,
+    u32 row_words
+) {
+    u32 scale = renderer->scale;
+    u32 cell_words = renderer->cell_words;
+    u32 row_len = width * cell_words;
+    for (u32 i = row_start; i < row_end; ++i) {
+        u64 *cells = &state->board[i * row_words];
+        u32 *row = &buf->map[
+            (renderer->y + i * scale) * buf->stride +
+            (renderer->x >> renderer->pixel_shift)
+        ];
+        u32 *line = row;
+        if (renderer->mode != RENDER_MODE_SPAN) {
+            line = scanline;
+        }
+
+        if (renderer->mode == RENDER_MODE_EXPAND) {
+            renderer->expand(
+                line,
+                cells,
+                width,
+                cell_words,
+                renderer->palette
+            );
+        } else {
+            u32 j = 0;
+            while (j < width) {
+                u32 k = board_run_end(cells, j, width);
+                renderer->fill(
+                    line + j * cell_words,
+                    (k - j) * cell_words,
+                    cell_color(renderer, board_test(cells, (i32)j))
+                );
+                j = k;
+            }
+        }
+
+        if (renderer->mode != RENDER_MODE_SPAN) {
+            for (u32 yoff = 0; yoff < scale; ++yoff) {
+                renderer->stream(row + yoff * buf->stride, line, row_len);
+            }
+        } else {
+            for (u32 yoff = 1; yoff < scale; ++yoff) {
+                renderer->copy(row + yoff * buf->stride, row, row_len);
+            }
+        }
+    }
+}
+
+void draw_game_rows(
+    struct renderer *renderer,
+    struct drm_mode_dumb_buffer *buf,
+    struct game_state *state,
+    u32 *scanline,
+    u32 row_start,
+    u32 row_end
+) {
+    switch (state->shape) {
+        case BOARD_SHAPE_90X90:
+            draw_board(
+                renderer,
+                buf,
+                state,
+                scanline,
+                90,
+                row_start,
+                row_end,
+                2
+            );
+            break;
+        case BOARD_SHAPE_120X90:
+            draw_board(
+                renderer,
+                buf,
+                state,
+                scanline,
+                120,
+                row_start,
+                row_end,
+                2
+            );
+            break;
+        case BOARD_SHAPE_160X90:
+            draw_board(
+                renderer,
+                buf,
+                state,
+                scanline,
+                160,
+                row_start,
+                row_end,
+                3
+            );
+            break;
+        default:
+            draw_board(
+                renderer,
+                buf,
+                state,
+                scanline,
+                (u32)state->width,
+                row_start,
+                row_end,
+                (u32)state->row_words
+            );
+            break;
+    }
+}
+
+void draw_game(
+    struct renderer *renderer,
+    struct drm_mode_dumb_buffer *buf,
+    struct game_state *state
+) {
+    if (renderer->bands != 0) {
+        band_pool_draw(renderer->bands, buf, state);
+        return;
+    }
+    draw_game_rows(
+        renderer,
+        buf,
+        state,
+        renderer->scanline,
+        0,
+        (u32)state->height
+    );
+}
+
+i32 draw_partial(
+    struct renderer *renderer,
+    struct drm_mode_dumb_buffer *buf,
+    struct game_state *state,
+    u32 partial
+) {
+    if (state->y == 0 && state->vy < 0) {
+        return -1;
+    }
+    if (state->y == state->height - 1 && state->vy > 0) {
+        return -1;
+    }
+    if (state->x == 0 && state->vx < 0) {
+        return -1;
+    }
+    if (state->x == state->width - 1 && state->vx > 0) {
+        return -1;
+    }
+
+    u32 scale = renderer->scale;
+    u32 xstart = 0;
+    u32 xend = scale;
+    if (state->vx > 0) {
+        xend = partial;
+    } else if (state->vx < 0) {
+        xstart = scale - partial;
+    }
+    u32 ystart = 0;
+    u32 yend = scale;
+    if (state->vy > 0) {
+        yend = partial;
+    } else if (state->vy < 0) {
+        ystart = scale - partial;
+    }
+
+    u32 cx = renderer->x + (u32)(state->x + state->vx) * scale;
+    u32 cy = renderer->y + (u32)(state->y + state->vy) * scale;
+    u32 wstart = (cx + xstart) >> renderer->pixel_shift;
+    u32 wend = (cx + xend) >> renderer->pixel_shift;
+    for (u32 yoff = ystart; yoff < yend; ++yoff) {
+        renderer->fill(
+            &buf->map[(cy + yoff) * buf->stride + wstart],
+            wend - wstart,
+            renderer->palette[1]
+        );
+    }
+
+    return (state->y + state->vy) * state->width + state->x + state->vx;
+}
+
+enum damage_limits {
+    DAMAGE_MAX_CLIPS = 32,
+    DAMAGE_STREAM_MIN_WIDTH = 64,
+};
+
+i32 board_damage_init(
+    struct board_damage *damage,
+    struct arena *arena,
+    struct game_state *state
+) {
+    damage->valid = 0;
+    damage->partial_cell = -1;
+    damage->clips_full = 1;
+    damage->clips_len = 0;
+    damage->board = alloc(
+        arena,
+        state->height * state->row_words * (i64)sizeof(u64)
+    );
+    damage->clips = alloc(
+        arena,
+        DAMAGE_MAX_CLIPS * (i64)sizeof(*damage->clips)
+    );
+    if (damage->board == 0 || damage->clips == 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static void damage_clip(
+    struct board_damage *damage,
+    struct drm_clip_rect *clip
+) {
+    if (damage->clips_full) {
+        return;
+    }
+    for (i32 i = 0; i < damage->clips_len; ++i) {
+        struct drm_clip_rect *other = &damage->clips[i];
+        if (
+            other->x1 == clip->x1 &&
+            other->y1 == clip->y1 &&
+            other->x2 == clip->x2 &&
+            other->y2 == clip->y2
+        ) {
+            return;
+        }
+    }
+    if (damage->clips_len == DAMAGE_MAX_CLIPS) {
+        damage->clips_full = 1;
+        return;
+    }
+    damage->clips[damage->clips_len] = *clip;
+    damage->clips_len += 1;
+}
+
+static void damage_clip_cell(
+    struct renderer *renderer,
+    struct board_damage *damage,
+    i32 x,
+    i32 y
+) {
+    u32 scale = renderer->scale;
+    struct drm_clip_rect clip = {
+        .x1 = (u16)(renderer->x + (u32)x * scale),
+        .y1 = (u16)(renderer->y + (u32)y * scale),
+        .x2 = (u16)(renderer->x + (u32)(x + 1) * scale),
+        .y2 = (u16)(renderer->y + (u32)(y + 1) * scale),
+    };
+    damage_clip(damage, &clip);
+}
+
+void board_damage_merge(struct board_damage *dst, struct board_damage *src) {
+    if (src->clips_full) {
+        dst->clips_full = 1;
+        return;
+    }
+    for (i32 i = 0; i < src->clips_len; ++i) {
+        damage_clip(dst, &src->clips[i]);
+    }
+}
+
+void copy_damage(
+    struct renderer *renderer,
+    struct drm_mode_dumb_buffer *dst,
+    struct drm_mode_dumb_buffer *src,
+    struct board_damage *damage
+) {
+    u32 shift = renderer->pixel_shift;
+    if (damage->clips_full) {
+        for (u32 y = 0; y < dst->height; ++y) {
+            renderer->stream(
+                &dst->map[y * dst->stride],
+                &src->map[y * src->stride],
+                dst->width >> shift
+            );
+        }
+        return;
+    }
+    for (i32 i = 0; i < damage->clips_len; ++i) {
+        struct drm_clip_rect *clip = &damage->clips[i];
+        u32 width = (u32)(clip->x2 - clip->x1);
+        u32 x = (u32)clip->x1 >> shift;
+        void (*copy)(u32 *dst, u32 *src, u64 len) = renderer->copy;
+        if (width >= DAMAGE_STREAM_MIN_WIDTH) {
+            copy = renderer->stream;
+        }
+        for (u32 y = clip->y1; y < clip->y2; ++y) {
+            copy(
+                &dst->map[y * dst->stride + x],
+                &src->map[y * src->stride + x],
+                width >> shift
+            );
+        }
+    }
+}
+
+void board_damage_submitted(struct board_damage *damage) {
+    damage->clips_full = 0;
+    damage->clips_len = 0;
+}
+
+static void draw_cell(
+    struct renderer *renderer,
+    struct drm_mode_dumb_buffer *buf,
+    i32 x,
+    i32 y,
+    u32 color
+) {
+    u32 scale = renderer->scale;
+    u32 cx = (renderer->x >> renderer->pixel_shift) +
+        (u32)x * renderer->cell_words;
+    u32 cy = renderer->y + (u32)y * scale;
+    for (u32 yoff = 0; yoff < scale; ++yoff) {
+        renderer->fill(
+            &buf->map[(cy + yoff) * buf->stride + cx],
+            renderer->cell_words,
+            color
+        );
+    }
+}
+
+static inline __attribute__((always_inline)) void draw_board_diff(
+    struct renderer *renderer,
+    struct drm_mode_dumb_buffer *buf,
+    struct board_damage *damage,
+    struct game_state *state,
+    i32 height,
+    i32 row_words
+) {
+    for (i32 i = 0; i < height * row_words; ++i) {
+        u64 diff = damage->board[i] ^ state->board[i];
+        damage->board[i] = state->board[i];
+        while (diff != 0) {
+            i32 x = (i % row_words) * 64 + __builtin_ctzl(diff);
+            i32 y = i / row_words;
+            draw_cell(
+                renderer,
+                buf,
+                x,
+                y,
+                cell_color(renderer, (i32)((state->board[i] >> (x % 64)) & 1))
+            );
+            damage_clip_cell(renderer, damage, x, y);
+            diff &= diff - 1;
+        }
+    }
+}
+
+void draw_damage(
+    struct renderer *renderer,
+    struct drm_mode_dumb_buffer *buf,
+    struct board_damage *damage,
+    struct game_state *state
+) {
+    if (!damage->valid || damage->epoch != state->epoch) {
+        draw_game(renderer, buf, state);
+        damage->valid = 1;
+        damage->epoch = state->epoch;
+        damage->partial_cell = -1;
+        damage->clips_full = 1;
+        memcpy(
+            damage->board,
+            state->board,
+            (u64)(state->height * state->row_words) * sizeof(u64)
+        );
+        return;
+    }
+
+    if (damage->partial_cell >= 0) {
+        i32 x = damage->partial_cell % state->width;
+        i32 y = damage->partial_cell / state->width;
+        draw_cell(
+            renderer,
+            buf,
+            x,
+            y,
+            cell_color(renderer, board_test(board_row(state, y), x))
+        );
+        damage_clip_cell(renderer, damage, x, y);
+        damage->partial_cell = -1;
+    }
+
+    switch (state->shape) {
+        case BOARD_SHAPE_90X90:
+        case BOARD_SHAPE_120X90:
+            draw_board_diff(renderer, buf, damage, state, 90, 2);
+            break;
+        case BOARD_SHAPE_160X90:
+            draw_board_diff(renderer, buf, damage, state, 90, 3);
+            break;
+        default:
+            draw_board_diff(
+                renderer,
+                buf,
+                damage,
+                state,
+                state->height,
+                state->row_words
+            );
+            break;
+    }
+}
+
+void draw_partial_damage(
+    struct renderer *renderer,
+    struct drm_mode_dumb_buffer *buf,
+    struct board_damage *damage,
+    struct game_state *state,
+    u32 partial
+) {
+    damage->partial_cell = draw_partial(renderer, buf, state, partial);
+    if (damage->partial_cell >= 0) {
+        damage_clip_cell(
+            renderer,
+            damage,
+            damage->partial_cell % state->width,
+            damage->partial_cell / state->width
+        );
+    }
+}
@@ -0,0 +1,106 @@
+#include "dumb_cycle.h"
+
+void histogram_clear(struct histogram *histogram) {
+    histogram->count = 0;
+    histogram->sum = 0;
+    histogram->min = 0;
+    histogram->max = 0;
+    memset(histogram->counts, 0, sizeof(histogram->counts));
+}
+
+static i32 histogram_index(u64 value) {
+    if (value < HISTOGRAM_SUB_BUCKETS) {
+        return (i32)value;
+    }
+    i32 exponent = 63 - __builtin_clzl(value);
+    i32 shift = exponent - HISTOGRAM_SUB_BITS;
+    u64 sub = (value >> shift) & (HISTOGRAM_SUB_BUCKETS - 1);
+    return (shift + 1) * HISTOGRAM_SUB_BUCKETS + (i32)sub;
+}
+
+static u64 histogram_highest(i32 index) {
+    if (index < HISTOGRAM_SUB_BUCKETS) {
+        return (u64)index;
+    }
+    i32 shift = index / HISTOGRAM_SUB_BUCKETS - 1;
+    u64 sub = (u64)(index % HISTOGRAM_SUB_BUCKETS);
+    return ((HISTOGRAM_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+void histogram_record(struct histogram *histogram, u64 value) {
+    if (histogram->count == 0 || value < histogram->min) {
+        histogram->min = value;
+    }
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+    histogram->count += 1;
+    histogram->sum += value;
+    histogram->counts[histogram_index(value)] += 1;
+}
+
+void histogram_merge(struct histogram *histogram, struct histogram *other) {
+    if (other->count == 0) {
+        return;
+    }
+    if (histogram->count == 0 || other->min < histogram->min) {
+        histogram->min = other->min;
+    }
+    if (other->max > histogram->max) {
+        histogram->max = other->max;
+    }
+    histogram->count += other->count;
+    histogram->sum += other->sum;
+    for (i32 i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        histogram->counts[i] += other->counts[i];
+    }
+}
+
+u64 histogram_percentile(struct histogram *histogram, u64 per_100000) {
+    if (histogram->count == 0) {
+        return 0;
+    }
+    u64 rank = (histogram->count * per_100000 + 99999) / 100000;
+    if (rank == 0) {
+        rank = 1;
+    }
+    u64 seen = 0;
+    for (i32 i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            u64 value = histogram_highest(i);
+            return (value > histogram->max) ? histogram->max : value;
+        }
+    }
+    return histogram->max;
+}
+
+void histogram_print(
+    struct print_buffer *out,
+    char *name,
+    char *unit,
+    struct histogram *histogram
+) {
+    print_str(out, name);
+    print_str(out, " (");
+    print_str(out, unit);
+    print_str(out, "): count=");
+    print_u64(out, histogram->count);
+    if (histogram->count != 0) {
+        print_str(out, " min=");
+        print_u64(out, histogram->min);
+        print_str(out, " mean=");
+        print_u64(out, histogram->sum / histogram->count);
+        print_str(out, " p50=");
+        print_u64(out, histogram_percentile(histogram, 50000));
+        print_str(out, " p90=");
+        print_u64(out, histogram_percentile(histogram, 90000));
+        print_str(out, " p99=");
+        print_u64(out, histogram_percentile(histogram, 99000));
+        print_str(out, " p99.9=");
+        print_u64(out, histogram_percentile(histogram, 99900));
+        print_str(out, " max=");
+        print_u64(out, histogram->max);
+    }
+    print_char(out, '\n');
+}
@@ -0,0 +1,483 @@
+#include "dumb_cycle.h"
+
+static i32 syscall_error(u64 return_value) {
+    if (return_value > -4096UL) {
+        return (i32)(-return_value);
+    }
+    return 0;
+}
+
+static struct syscall_layer *syscall_layer;
+static struct syscall_stats *syscall_stats;
+static i32 syscall_hooked;
+
+void syscall_layer_set(struct syscall_layer *layer) {
+    syscall_layer = layer;
+    syscall_hooked = syscall_layer != 0 || syscall_stats != 0;
+}
+
+static void syscall_count(struct syscall_counter *counter, u64 cycles) {
+    __atomic_add_fetch(&counter->calls, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&counter->cycles, cycles, __ATOMIC_RELAXED);
+}
+
+static void syscall_account(u64 scid, u64 *args, u64 cycles) {
+    if (scid < SYSCALL_STATS_SYSCALLS) {
+        syscall_count(&syscall_stats->syscalls[scid], cycles);
+    }
+    if (scid != SYS_IOCTL) {
+        return;
+    }
+
+    u64 request = args[1] & 0xffffffffUL;
+    for (i32 i = 0; i < SYSCALL_STATS_IOCTLS; ++i) {
+        struct syscall_counter *counter = &syscall_stats->ioctls[i];
+        u64 key = __atomic_load_n(&counter->key, __ATOMIC_RELAXED);
+        if (key == 0) {
+            u64 expected = 0;
+            __atomic_compare_exchange_n(
+                &counter->key,
+                &expected,
+                request,
+                0,
+                __ATOMIC_RELAXED,
+                __ATOMIC_RELAXED
+            );
+            key = __atomic_load_n(&counter->key, __ATOMIC_RELAXED);
+        }
+        if (key == request) {
+            syscall_count(counter, cycles);
+            return;
+        }
+    }
+}
+
+static u64 syscall_dispatch(u64 scid, u64 *args) {
+    u64 start = 0;
+    if (syscall_stats != 0) {
+        start = cycle_count();
+    }
+
+    u64 return_value;
+    if (syscall_layer != 0) {
+        return_value = syscall_layer->call(syscall_layer->ctx, scid, args);
+    } else {
+        return_value = syscall6(
+            scid,
+            args[0],
+            args[1],
+            args[2],
+            args[3],
+            args[4],
+            args[5]
+        );
+    }
+
+    if (syscall_stats != 0) {
+        syscall_account(scid, args, cycle_count() - start);
+    }
+    return return_value;
+}
+
+static u64 sys1(u64 scid, u64 a1) {
+    if (!syscall_hooked) {
+        return syscall1(scid, a1);
+    }
+    u64 args[6] = { a1, 0, 0, 0, 0, 0 };
+    return syscall_dispatch(scid, args);
+}
+
+static u64 sys2(u64 scid, u64 a1, u64 a2) {
+    if (!syscall_hooked) {
+        return syscall2(scid, a1, a2);
+    }
+    u64 args[6] = { a1, a2, 0, 0, 0, 0 };
+    return syscall_dispatch(scid, args);
+}
+
+static u64 sys3(u64 scid, u64 a1, u64 a2, u64 a3) {
+    if (!syscall_hooked) {
+        return syscall3(scid, a1, a2, a3);
+    }
+    u64 args[6] = { a1, a2, a3, 0, 0, 0 };
+    return syscall_dispatch(scid, args);
+}
+
+static u64 sys4(u64 scid, u64 a1, u64 a2, u64 a3, u64 a4) {
+    if (!syscall_hooked) {
+        return syscall4(scid, a1, a2, a3, a4);
+    }
+    u64 args[6] = { a1, a2, a3, a4, 0, 0 };
+    return syscall_dispatch(scid, args);
+}
+
+static u64 sys6(u64 scid, u64 a1, u64 a2, u64 a3, u64 a4, u64 a5, u64 a6) {
+    if (!syscall_hooked) {
+        return syscall6(scid, a1, a2, a3, a4, a5, a6);
+    }
+    u64 args[6] = { a1, a2, a3, a4, a5, a6 };
+    return syscall_dispatch(scid, args);
+}
+
+i64 read(i32 fd, char *bytes, i64 bytes_len) {
+    u64 return_value;
+    i32 error;
+    do {
+        return_value = sys3(SYS_READ, (u64)fd, (u64)bytes, (u64)bytes_len);
+        error = syscall_error(return_value);
+    } while (error == EINTR);
+    if (error != 0) {
+        return -error;
+    }
+    return (i64)return_value;
+}
+
+i64 write(i32 fd, char *bytes, i64 bytes_len) {
+    u64 return_value;
+    i32 error;
+    do {
+        return_value = sys3(SYS_WRITE, (u64)fd, (u64)bytes, (u64)bytes_len);
+        error = syscall_error(return_value);
+    } while (error == EINTR);
+    if (error != 0) {
+        return -error;
+    }
+    return (i64)return_value;
+}
+
+i32 open(char *fname, i32 mode, i32 flags) {
+    u64 return_value;
+    i32 error;
+    do {
+        return_value = sys3(SYS_OPEN, (u64)fname, (u64)mode, (u64)flags);
+        error = syscall_error(return_value);
+    } while (error == EINTR);
+
+    if (error != 0) {
+        return -error;
+    }
+    return (i32)return_value;
+}
+
+i32 close(i32 fd) {
+    u64 return_value;
+    i32 error;
+    do {
+        return_value = sys1(SYS_CLOSE, (u64)fd);
+        error = syscall_error(return_value);
+    } while (error == EINTR);
+    return error;
+}
+
+i32 poll(struct pollfd *fds, i64 fds_len, i32 time_ms) {
+    u64 return_value;
+    i32 error;
+    do {
+        return_value = sys3(SYS_POLL, (u64)fds, (u64)fds_len, (u64)time_ms);
+        error = syscall_error(return_value);
+    } while (error == EINTR);
+    if (error != 0) {
+        return -error;
+    }
+    return (i32)return_value;
+}
+
+void *mmap(void *hint, i64 size, i32 prot, i32 flags, i32 fd, i64 offset) {
+    u64 return_value = sys6(
+        SYS_MMAP,
+        (u64)hint,
+        (u64)size,
+        (u64)prot,
+        (u64)flags,
+        (u64)fd,
+        (u64)offset
+    );
+    i32 error = syscall_error(return_value);
+    if (error != 0) {
+        return 0;
+    }
+    return (void *)return_value;
+}
+
+i32 munmap(void *addr, i64 size) {
+    u64 return_value = sys2(SYS_MUNMAP, (u64)addr, (u64)size);
+    return syscall_error(return_value);
+}
+
+i32 madvise(void *addr, i64 size, i32 advice) {
+    u64 return_value = sys3(SYS_MADVISE, (u64)addr, (u64)size, (u64)advice);
+    return syscall_error(return_value);
+}
+
+i32 ioctl(i32 fd, u32 dir, u32 type, u32 number, u32 size, char *arg) {
+    u32 number_bits = number & 0xff;
+    u32 type_bits = (type & 0xff) << 8;
+    u32 size_bits = (size & 0x3fff) << 16;
+    u32 dir_bits = (dir & 0x3) << 30;
+    u32 request = dir_bits | size_bits | type_bits | number_bits;
+
+    u64 return_value;
+    i32 error;
+    do {
+        return_value = sys3(SYS_IOCTL, (u64)fd, (u64)request, (u64)arg);
+        error = syscall_error(return_value);
+    } while (error == EINTR);
+    return error;
+}
+
+void exit(i32 error_code) {
+    sys1(SYS_EXIT_GROUP, (u64)error_code);
+}
+
+i64 getdents(i32 fd, struct dirent *dents, i64 dents_size) {
+    u64 return_value = sys3(
+        SYS_GETDENTS,
+        (u64)fd,
+        (u64)dents,
+        (u64)dents_size
+    );
+    i32 error = syscall_error(return_value);
+    if (error != 0) {
+        return -error;
+    }
+    return (i64)return_value;
+}
+
+i32 clock_gettime(i32 clock_id, struct timespec *timespec) {
+    u64 return_value = sys2(SYS_CLOCK_GETTIME, (u64)clock_id, (u64)timespec);
+    return syscall_error(return_value);
+}
+
+i64 time_since_ns(struct timespec *end, struct timespec *start) {
+    i64 seconds = end->sec - start->sec;
+    return (seconds * 1000L * 1000L * 1000L) + end->nsec - start->nsec;
+}
+
+void syscall_stats_enable(struct syscall_stats *stats) {
+    struct timespec now;
+    syscall2(SYS_CLOCK_GETTIME, CLOCK_MONOTONIC, (u64)&now);
+    stats->start_ns = now.sec * 1000L * 1000L * 1000L + now.nsec;
+    stats->start_cycles = cycle_count();
+    stats->ns_scale = 0;
+    syscall_stats = stats;
+    syscall_hooked = 1;
+}
+
+void syscall_stats_disable(void) {
+    syscall_stats = 0;
+    syscall_hooked = syscall_layer != 0;
+}
+
+void syscall_stats_calibrate(struct syscall_stats *stats) {
+    struct timespec now;
+    syscall2(SYS_CLOCK_GETTIME, CLOCK_MONOTONIC, (u64)&now);
+    u64 cycles = cycle_count() - stats->start_cycles;
+    i64 elapsed = now.sec * 1000L * 1000L * 1000L + now.nsec - stats->start_ns;
+    if (cycles > 0 && elapsed > 0) {
+        stats->ns_scale = ((u64)elapsed << 20) / cycles;
+    }
+}
+
+i32 timerfd_create(i32 clock_id, i32 flags) {
+    u64 return_value = sys2(
+        SYS_TIMERFD_CREATE,
+        (u64)clock_id,
+        (u64)flags
+    );
+    i32 error = syscall_error(return_value);
+    if (error != 0) {
+        return -error;
+    }
+    return (i32)return_value;
+}
+
+i32 timerfd_settime(i32 fd, i32 flags, struct itimerspec *value) {
+    u64 return_value = sys4(
+        SYS_TIMERFD_SETTIME,
+        (u64)fd,
+        (u64)flags,
+        (u64)value,
+        0
+    );
+    return syscall_error(return_value);
+}
+
+i32 openat(i32 dfd, char *fname, i32 mode, i32 flags) {
+    u64 return_value;
+    i32 error;
+    do {
+        return_value = sys4(
+            SYS_OPENAT,
+            (u64)dfd,
+            (u64)fname,
+            (u64)mode,
+            (u64)flags
+        );
+        error = syscall_error(return_value);
+    } while (error == EINTR);
+
+    if (error != 0) {
+        return -error;
+    }
+    return (i32)return_value;
+}
+
+i32 rt_sigprocmask(i32 how, u64 *set, u64 *old_set) {
+    u64 return_value = sys4(
+        SYS_RT_SIGPROCMASK,
+        (u64)how,
+        (u64)set,
+        (u64)old_set,
+        sizeof(*set)
+    );
+    return syscall_error(return_value);
+}
+
+i32 signalfd(i32 fd, u64 *mask, i32 flags) {
+    u64 return_value = sys4(
+        SYS_SIGNALFD4,
+        (u64)fd,
+        (u64)mask,
+        sizeof(*mask),
+        (u64)flags
+    );
+    i32 error = syscall_error(return_value);
+    if (error != 0) {
+        return -error;
+    }
+    return (i32)return_value;
+}
+
+i32 epoll_create1(i32 flags) {
+    u64 return_value = sys1(SYS_EPOLL_CREATE1, (u64)flags);
+    i32 error = syscall_error(return_value);
+    if (error != 0) {
+        return -error;
+    }
+    return (i32)return_value;
+}
+
+i32 epoll_ctl(i32 epfd, i32 op, i32 fd, struct epoll_event *event) {
+    u64 return_value = sys4(
+        SYS_EPOLL_CTL,
+        (u64)epfd,
+        (u64)op,
+        (u64)fd,
+        (u64)event
+    );
+    return syscall_error(return_value);
+}
+
+i32 epoll_wait(
+    i32 epfd,
+    struct epoll_event *events,
+    i32 events_len,
+    i32 time_ms
+) {
+    u64 return_value;
+    i32 error;
+    do {
+        return_value = sys4(
+            SYS_EPOLL_WAIT,
+            (u64)epfd,
+            (u64)events,
+            (u64)events_len,
+            (u64)time_ms
+        );
+        error = syscall_error(return_value);
+    } while (error == EINTR);
+    if (error != 0) {
+        return -error;
+    }
+    return (i32)return_value;
+}
+
+i32 prctl(i32 option, u64 arg) {
+    u64 return_value = sys2(SYS_PRCTL, (u64)option, arg);
+    return syscall_error(return_value);
+}
+
+i32 cpu_count(void) {
+    u64 mask[16];
+    u64 return_value = sys3(
+        SYS_SCHED_GETAFFINITY,
+        0,
+        sizeof(mask),
+        (u64)mask
+    );
+    if (syscall_error(return_value) != 0) {
+        return 1;
+    }
+    i32 count = 0;
+    for (u64 i = 0; i < return_value / sizeof(*mask); ++i) {
+        for (u64 bits = mask[i]; bits != 0; bits &= bits - 1) {
+            count += 1;
+        }
+    }
+    return (count > 0) ? count : 1;
+}
+
+enum clone_flag {
+    CLONE_VM = 0x100,
+    CLONE_FS = 0x200,
+    CLONE_FILES = 0x400,
+    CLONE_SIGHAND = 0x800,
+    CLONE_THREAD = 0x10000,
+    CLONE_SYSVSEM = 0x40000,
+    CLONE_PARENT_SETTID = 0x100000,
+    CLONE_CHILD_CLEARTID = 0x200000,
+};
+
+i32 thread_create(
+    struct thread *thread,
+    char *stack,
+    i64 stack_size,
+    void (*start)(void *),
+    void *arg
+) {
+    u64 flags = CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_SIGHAND |
+        CLONE_THREAD | CLONE_SYSVSEM | CLONE_PARENT_SETTID |
+        CLONE_CHILD_CLEARTID;
+    u64 return_value = (u64)clone_thread(
+        flags,
+        stack + stack_size,
+        &thread->tid,
+        &thread->tid,
+        start,
+        arg
+    );
+    return syscall_error(return_value);
+}
+
+void thread_join(struct thread *thread) {
+    u32 tid;
+    while ((tid = __atomic_load_n(&thread->tid, __ATOMIC_ACQUIRE)) != 0) {
+        futex_wait(&thread->tid, tid);
+    }
+}
+
+i32 io_uring_setup(u32 entries, struct io_uring_params *params) {
+    u64 return_value = sys2(SYS_IO_URING_SETUP, (u64)entries, (u64)params);
+    i32 error = syscall_error(return_value);
+    if (error != 0) {
+        return -error;
+    }
+    return (i32)return_value;
+}
+
+i32 io_uring_enter(i32 fd, u32 to_submit, u32 min_complete, u32 flags) {
+    u64 return_value = sys6(
+        SYS_IO_URING_ENTER,
+        (u64)fd,
+        (u64)to_submit,
+        (u64)min_complete,
+        (u64)flags,
+        0,
+        0
+    );
+    i32 error = syscall_error(return_value);
+    if (error != 0) {
+        return -error;
+    }
+    return (i32)return_value;
+}
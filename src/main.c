@@ -1,260 +1,88 @@
-typedef short i16;
-typedef unsigned short u16;
-typedef int i32;
-typedef unsigned int u32;
-typedef long i64;
-typedef unsigned long u64;
-
-u64 syscall0(u64 scid);
-u64 syscall1(u64 scid, u64 a1);
-u64 syscall2(u64 scid, u64 a1, u64 a2);
-u64 syscall3(u64 scid, u64 a1, u64 a2, u64 a3);
-u64 syscall4(u64 scid, u64 a1, u64 a2, u64 a3, u64 a4);
-u64 syscall5(u64 scid, u64 a1, u64 a2, u64 a3, u64 a4, u64 a5);
-u64 syscall6(u64 scid, u64 a1, u64 a2, u64 a3, u64 a4, u64 a5, u64 a6);
-
-enum syscall {
-    SYS_READ = 0,
-    SYS_WRITE = 1,
-    SYS_OPEN = 2,
-    SYS_CLOSE = 3,
-    SYS_POLL = 7,
-    SYS_MMAP = 9,
-    SYS_IOCTL = 16,
-    SYS_EXIT = 60,
-    SYS_GETDENTS = 78,
-    SYS_CLOCK_GETTIME = 228,
-    SYS_OPENAT = 257,
-};
+#include "dumb_cycle.h"
 
-enum error_code {
-    EINTR = 4,
+enum madvise_advice {
+    MADV_HUGEPAGE = 14,
 };
 
-static i32 syscall_error(u64 return_value) {
-    if (return_value > -4096UL) {
-        return (i32)(-return_value);
-    }
-    return 0;
-}
-
-static i64 read(i32 fd, char *bytes, i64 bytes_len) {
-    u64 return_value;
-    i32 error;
-    do {
-        return_value = syscall3(SYS_READ, (u64)fd, (u64)bytes, (u64)bytes_len);
-        error = syscall_error(return_value);
-    } while (error == EINTR);
-    if (error != 0) {
-        return -error;
-    }
-    return (i64)return_value;
-}
-
-enum open_mode {
-    O_RDONLY = 0,
-    O_WRONLY = 1,
-    O_RDWR = 2,
+enum epoll_op {
+    EPOLL_CTL_ADD = 1,
 };
 
-static i32 open(char *fname, i32 mode, i32 flags) {
-    u64 return_value;
-    i32 error;
-    do {
-        return_value = syscall3(SYS_OPEN, (u64)fname, (u64)mode, (u64)flags);
-        error = syscall_error(return_value);
-    } while (error == EINTR);
-
-    if (error != 0) {
-        return -error;
-    }
-    return (i32)return_value;
-}
-
-static i32 close(i32 fd) {
-    u64 return_value;
-    i32 error;
-    do {
-        return_value = syscall1(SYS_CLOSE, (u64)fd);
-        error = syscall_error(return_value);
-    } while (error == EINTR);
-    return error;
-}
-
-enum poll_event {
-    POLLIN = 1,
+enum epoll_event_flag {
+    EPOLLIN = 1,
 };
 
-struct pollfd {
-    i32 fd;
-    i16 events;
-    i16 revents;
+enum prctl_option {
+    PR_SET_TIMERSLACK = 29,
 };
 
-static i32 poll(struct pollfd *fds, i64 fds_len, i32 time_ms) {
-    u64 return_value;
-    i32 error;
-    do {
-        return_value = syscall3(SYS_POLL, (u64)fds, (u64)fds_len, (u64)time_ms);
-        error = syscall_error(return_value);
-    } while (error == EINTR);
-    if (error != 0) {
-        return -error;
-    }
-    return (i32)return_value;
-}
-
-enum mmap_prot {
-    PROT_READ = 1,
-    PROT_WRITE = 2,
+enum signal {
+    SIGINT = 2,
+    SIGUSR1 = 10,
+    SIGTERM = 15,
 };
 
-enum mmap_flag {
-    MAP_SHARED = 0x01,
-    MAP_ANONYMOUS = 0x20,
+enum sigprocmask_how {
+    SIG_BLOCK = 0,
 };
 
-static void *mmap(void *hint, i64 size, i32 prot, i32 flags, i32 fd, i64 offset) {
-    u64 return_value = syscall6(
-        SYS_MMAP,
-        (u64)hint,
-        (u64)size,
-        (u64)prot,
-        (u64)flags,
-        (u64)fd,
-        (u64)offset
-    );
-    i32 error = syscall_error(return_value);
-    if (error != 0) {
-        return 0;
-    }
-    return (void *)return_value;
-}
-
-enum ioctl_dir {
-    IOCTL_WRITE = 1,
-    IOCTL_READ = 2,
-    IOCTL_RDWR = 3,
+struct signalfd_siginfo {
+    u32 signo;
+    char pad[124];
 };
 
-static i32 ioctl(i32 fd, u32 dir, u32 type, u32 number, u32 size, char *arg) {
-    u32 number_bits = number & 0xff;
-    u32 type_bits = (type & 0xff) << 8;
-    u32 size_bits = (size & 0x3fff) << 16;
-    u32 dir_bits = (dir & 0x3) << 30;
-    u32 request = dir_bits | size_bits | type_bits | number_bits;
-
-    u64 return_value;
-    i32 error;
-    do {
-        return_value = syscall3(SYS_IOCTL, (u64)fd, (u64)request, (u64)arg);
-        error = syscall_error(return_value);
-    } while (error == EINTR);
-    return error;
-}
-
-static void exit(i32 error_code) {
-    syscall1(SYS_EXIT, (u64)error_code);
-}
-
-struct dirent {
-    u64 ino;
-    u64 off;
-    u16 reclen;
-    char name[];
+enum arena_layout {
+    ARENA_SIZE = 8 * 1024 * 1024,
+    FRAME_SCRATCH_SIZE = 64 * 1024,
+    KEYBOARD_EVENTS_LEN = 32,
+    DISPLAY_EVENTS_SIZE = 4096,
+    HUGE_PAGE_SIZE = 2 * 1024 * 1024,
 };
 
-static i64 getdents(i32 fd, struct dirent *dents, i64 dents_size) {
-    u64 return_value = syscall3(
-        SYS_GETDENTS,
-        (u64)fd,
-        (u64)dents,
-        (u64)dents_size
-    );
-    i32 error = syscall_error(return_value);
-    if (error != 0) {
-        return -error;
+static char *arena_map(i64 size, i32 huge_pages) {
+    if (!huge_pages) {
+        return mmap(
+            0,
+            size,
+            PROT_WRITE | PROT_READ,
+            MAP_SHARED | MAP_ANONYMOUS,
+            -1,
+            0
+        );
     }
-    return (i64)return_value;
-}
-
-enum clock_id {
-    CLOCK_MONOTONIC = 1,
-};
 
-struct timespec {
-    i64 sec;
-    i64 nsec;
-};
-
-static i32 clock_gettime(i32 clock_id, struct timespec *timespec) {
-    u64 return_value = syscall2(SYS_CLOCK_GETTIME, (u64)clock_id, (u64)timespec);
-    return syscall_error(return_value);
-}
-
-static i64 time_since_ns(struct timespec *end, struct timespec *start) {
-    i64 seconds = end->sec - start->sec;
-    return (seconds * 1000L * 1000L * 1000L) + end->nsec - start->nsec;
-}
-
-static i32 openat(i32 dfd, char *fname, i32 mode, i32 flags) {
-    u64 return_value;
-    i32 error;
-    do {
-        return_value = syscall4(
-            SYS_OPENAT,
-            (u64)dfd,
-            (u64)fname,
-            (u64)mode,
-            (u64)flags
-        );
-        error = syscall_error(return_value);
-    } while (error == EINTR);
+    char *mem = mmap(
+        0,
+        size,
+        PROT_WRITE | PROT_READ,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+        -1,
+        0
+    );
+    if (mem != 0) {
+        return mem;
+    }
 
-    if (error != 0) {
-        return -error;
+    mem = mmap(
+        0,
+        size + HUGE_PAGE_SIZE,
+        PROT_WRITE | PROT_READ,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+    if (mem == 0) {
+        return 0;
     }
-    return (i32)return_value;
+    char *aligned = mem + (-(i64)mem & (HUGE_PAGE_SIZE - 1));
+    if (aligned != mem) {
+        munmap(mem, aligned - mem);
+    }
+    munmap(aligned + size, mem + HUGE_PAGE_SIZE - aligned);
+    madvise(aligned, size, MADV_HUGEPAGE);
+    return aligned;
 }
 
-enum std_fd {
-    STDIN = 0,
-    STDOUT = 1,
-    STDERR = 2,
-};
-
-struct arena {
-    char *start;
-    char *end;
-};
-
-void *alloc(struct arena *arena, i64 size);
-
-enum ioctl_type {
-    IOCTL_EV = (i32)'E',
-    IOCTL_DRM = (i32)'d',
-};
-
-enum ev_ioctl {
-    EV_IOCTL_GET_BIT = 0x20,
-    EV_IOCTL_GET_KEY = 0x21,
-    EV_IOCTL_GRAB = 0x90,
-};
-
-enum ev_bits {
-    EV_KEY = 0x1,
-    EV_MAX = 0x1f,
-};
-
-enum ev_key_bits {
-    KEY_ESC = 1,
-    KEY_W = 17,
-    KEY_A = 30,
-    KEY_S = 31,
-    KEY_D = 32,
-    KEY_MAX = 0x2ff,
-};
-
 static i32 test_bit(char *bytes, i32 len, i32 bit_num) {
     i32 byte_index = bit_num / 8;
     i32 bit_index = bit_num % 8;
@@ -307,7 +135,7 @@ static i32 is_keyboard(i32 fd) {
 }
 
 static i32 open_keyboards(
-    struct arena temp_arena,
+    struct arena *arena,
     i32 *keyboards,
     i32 keyboards_capacity
 ) {
@@ -317,7 +145,12 @@ static i32 open_keyboards(
         return -1;
     }
 
-    void *dents = alloc(&temp_arena, 1024);
+    struct arena_checkpoint checkpoint = arena_save(arena);
+    void *dents = alloc_uninit(arena, 1024);
+    if (dents == 0) {
+        close(input_dir_fd);
+        return -1;
+    }
 
     i64 dents_pos = 0;
     i64 dents_len = 0;
@@ -352,62 +185,37 @@ static i32 open_keyboards(
             continue;
         }
 
+        i32 clock_id = CLOCK_MONOTONIC;
+        ioctl(
+            keyboard_fd,
+            IOCTL_WRITE,
+            IOCTL_EV,
+            EV_IOCTL_SET_CLOCK_ID,
+            sizeof(clock_id),
+            (char *)&clock_id
+        );
+
         keyboards[keyboards_len] = keyboard_fd;
         keyboards_len += 1;
     }
 
     close(input_dir_fd);
+    arena_restore(arena, checkpoint);
     return keyboards_len;
 }
 
-struct input_event {
-    struct timespec time;
-    u16 type;
-    u16 code;
-    i32 value;
-};
-
-enum drm_ioctl {
-    DRM_IOCTL_MODE_GET_RESOURCES = 0xa0,
-    DRM_IOCTL_MODE_GET_CONNECTOR = 0xa7,
-    DRM_IOCTL_MODE_GET_ENCODER = 0xa6,
-    DRM_IOCTL_MODE_ADD_FB = 0xae,
-    DRM_IOCTL_MODE_CREATE_DUMB = 0xb2,
-    DRM_IOCTL_MODE_MAP_DUMB = 0xb3,
-    DRM_IOCTL_MODE_GET_CRTC = 0xa1,
-    DRM_IOCTL_MODE_SET_CRTC = 0xa2,
-    DRM_IOCTL_MODE_PAGE_FLIP = 0xb0,
-};
-
-struct drm_mode_resources {
-    u32 *fbs;
-    u32 *crtcs;
-    u32 *connectors;
-    u32 *encoders;
-
-    u32 fbs_len;
-    u32 crtcs_len;
-    u32 connectors_len;
-    u32 encoders_len;
-
-    u32 min_width;
-    u32 max_width;
-    u32 min_height;
-    u32 max_height;
-};
-
 static struct drm_mode_resources *drm_mode_get_resources(
     struct arena *arena,
     i32 fd
 ) {
     struct drm_mode_resources prev_res;
     struct drm_mode_resources *res;
-    struct arena temp_arena;
+    struct arena_checkpoint checkpoint = arena_save(arena);
     i32 error;
 
     do {
-        temp_arena = *arena;
-        res = alloc(&temp_arena, sizeof(*res));
+        arena_restore(arena, checkpoint);
+        res = alloc(arena, sizeof(*res));
         if (res == 0) {
             return 0;
         }
@@ -420,41 +228,46 @@ static struct drm_mode_resources *drm_mode_get_resources(
             (char *)res
         );
         if (error != 0) {
+            arena_restore(arena, checkpoint);
             return 0;
         }
 
         prev_res = *res;
 
         if (res->fbs_len > 0) {
-            res->fbs = alloc(&temp_arena, res->fbs_len * sizeof(*res->fbs));
+            res->fbs = alloc(arena, res->fbs_len * sizeof(*res->fbs));
             if (res->fbs == 0) {
+                arena_restore(arena, checkpoint);
                 return 0;
             }
         }
         if (res->crtcs_len > 0) {
             res->crtcs = alloc(
-                &temp_arena,
+                arena,
                 res->crtcs_len * sizeof(*res->crtcs)
             );
             if (res->crtcs == 0) {
+                arena_restore(arena, checkpoint);
                 return 0;
             }
         }
         if (res->connectors_len > 0) {
             res->connectors = alloc(
-                &temp_arena,
+                arena,
                 res->connectors_len * sizeof(*res->connectors)
             );
             if (res->connectors == 0) {
+                arena_restore(arena, checkpoint);
                 return 0;
             }
         }
         if (res->encoders_len > 0) {
             res->encoders = alloc(
-                &temp_arena,
+                arena,
                 res->encoders_len * sizeof(*res->encoders)
             );
             if (res->encoders == 0) {
+                arena_restore(arena, checkpoint);
                 return 0;
             }
         }
@@ -468,6 +281,7 @@ static struct drm_mode_resources *drm_mode_get_resources(
             (char *)res
         );
         if (error != 0) {
+            arena_restore(arena, checkpoint);
             return 0;
         }
     } while (
@@ -477,7 +291,6 @@ static struct drm_mode_resources *drm_mode_get_resources(
         prev_res.encoders_len < res->encoders_len
     );
 
-    *arena = temp_arena;
     return res;
 }
 
@@ -485,50 +298,6 @@ enum drm_mode {
     DRM_MODE_CONNECTED = 1,
 };
 
-struct drm_mode_modeinfo {
-    u32 clock;
-
-    u16 hdisplay;
-    u16 hsync_start;
-    u16 hsync_end;
-    u16 htotal;
-    u16 hskew;
-
-    u16 vdisplay;
-    u16 vsync_start;
-    u16 vsync_end;
-    u16 vtotal;
-    u16 vscan;
-
-    u32 vrefresh;
-
-    u32 flags;
-    u32 type;
-    char name[32];
-};
-
-struct drm_mode_connector {
-    u32 *encoders;
-    struct drm_mode_modeinfo *modes;
-    u32 *props;
-    u64 *prop_values;
-
-    u32 modes_len;
-    u32 props_len;
-    u32 encoders_len;
-
-    u32 encoder_id;
-    u32 connector_id;
-
-    u32 connector_type;
-    u32 connector_type_id;
-    u32 connection;
-    u32 mm_width;
-    u32 mm_height;
-    u32 subpixel;
-    u32 pad;
-};
-
 static struct drm_mode_connector *drm_mode_get_connector(
     struct arena *arena,
     i32 fd,
@@ -536,12 +305,12 @@ static struct drm_mode_connector *drm_mode_get_connector(
 ) {
     struct drm_mode_connector prev_conn;
     struct drm_mode_connector *conn;
-    struct arena temp_arena;
+    struct arena_checkpoint checkpoint = arena_save(arena);
     i32 error;
 
     do {
-        temp_arena = *arena;
-        conn = alloc(&temp_arena, sizeof(*conn));
+        arena_restore(arena, checkpoint);
+        conn = alloc(arena, sizeof(*conn));
         if (conn == 0) {
             return 0;
         }
@@ -555,6 +324,7 @@ static struct drm_mode_connector *drm_mode_get_connector(
             (char *)conn
         );
         if (error != 0) {
+            arena_restore(arena, checkpoint);
             return 0;
         }
 
@@ -562,32 +332,35 @@ static struct drm_mode_connector *drm_mode_get_connector(
 
         if (conn->props_len > 0) {
             conn->props = alloc(
-                &temp_arena,
+                arena,
                 conn->props_len * sizeof(*conn->props)
             );
             conn->prop_values = alloc(
-                &temp_arena,
+                arena,
                 conn->props_len * sizeof(*conn->prop_values)
             );
             if (conn->props == 0 || conn->prop_values == 0) {
+                arena_restore(arena, checkpoint);
                 return 0;
             }
         }
         if (conn->modes_len > 0) {
             conn->modes = alloc(
-                &temp_arena,
+                arena,
                 conn->modes_len * sizeof(*conn->modes)
             );
             if (conn->modes == 0) {
+                arena_restore(arena, checkpoint);
                 return 0;
             }
         }
         if (conn->encoders_len > 0) {
             conn->encoders = alloc(
-                &temp_arena,
+                arena,
                 conn->encoders_len * sizeof(*conn->encoders)
             );
             if (conn->encoders == 0) {
+                arena_restore(arena, checkpoint);
                 return 0;
             }
         }
@@ -601,6 +374,7 @@ static struct drm_mode_connector *drm_mode_get_connector(
             (char *)conn
         );
         if (error != 0) {
+            arena_restore(arena, checkpoint);
             return 0;
         }
     } while (
@@ -609,29 +383,18 @@ static struct drm_mode_connector *drm_mode_get_connector(
         prev_conn.encoders_len < conn->encoders_len
     );
 
-    *arena = temp_arena;
     return conn;
 }
 
-struct drm_mode_encoder {
-    u32 encoder_id;
-    u32 encoder_type;
-
-    u32 crtc_id;
-
-    u32 possible_crtcs;
-    u32 possible_clones;
-};
-
 static struct drm_mode_encoder *drm_mode_get_encoder(
     struct arena *arena,
     i32 fd,
     u32 encoder_id
 ) {
-    struct arena temp_arena = *arena;
+    struct arena_checkpoint checkpoint = arena_save(arena);
     struct drm_mode_encoder *enc = 0;
 
-    enc = alloc(&temp_arena, sizeof(*enc));
+    enc = alloc(arena, sizeof(*enc));
     if (enc == 0) {
         return 0;
     }
@@ -646,59 +409,25 @@ static struct drm_mode_encoder *drm_mode_get_encoder(
         (char *)enc
     );
     if (error != 0) {
+        arena_restore(arena, checkpoint);
         return 0;
     }
 
-    *arena = temp_arena;
     return enc;
 }
 
-struct drm_mode_create_dumb {
-    u32 height;
-    u32 width;
-    u32 bpp;
-    u32 flags;
-    u32 handle;
-    u32 pitch;
-    u64 size;
-};
-
-struct drm_mode_map_dumb {
-    u32 handle;
-    u32 pad;
-    i64 offset;
-};
-
-struct drm_mode_fb_cmd {
-    u32 fb_id;
-    u32 width;
-    u32 height;
-    u32 pitch;
-    u32 bpp;
-    u32 depth;
-    u32 handle;
-};
-
-struct drm_mode_dumb_buffer {
-    u32 width;
-    u32 height;
-    u32 stride;
-    u32 handle;
-    u32 fb_id;
-    u32 *map;
-    u64 size;
-};
-
 static struct drm_mode_dumb_buffer *drm_mode_create_dumb_buffer(
     struct arena *arena,
     i32 fd,
     u32 width,
-    u32 height
+    u32 height,
+    u32 bpp,
+    u32 depth
 ) {
     struct drm_mode_create_dumb creq = {
         .width = width,
         .height = height,
-        .bpp = 32,
+        .bpp = bpp,
     };
     i32 error = ioctl(
         fd,
@@ -716,8 +445,8 @@ static struct drm_mode_dumb_buffer *drm_mode_create_dumb_buffer(
         .width = width,
         .height = height,
         .pitch = creq.pitch,
-        .bpp = 32,
-        .depth = 24,
+        .bpp = bpp,
+        .depth = depth,
         .handle = creq.handle,
     };
     error = ioctl(
@@ -766,37 +495,20 @@ static struct drm_mode_dumb_buffer *drm_mode_create_dumb_buffer(
     buf->map = mem;
     buf->fb_id = fb_cmd.fb_id;
 
-    for (u64 i = 0; i < buf->size; ++i) {
-        buf->map[i] = 0;
-    }
+    memset_stream(buf->map, 0, buf->size * sizeof(u32));
 
     return buf;
 }
 
-struct drm_mode_crtc {
-    u32 *set_connectors;
-    u32 connectors_len;
-
-    u32 crtc_id;
-    u32 fb_id;
-
-    u32 x;
-    u32 y;
-
-    u32 gamma_size;
-    u32 mode_valid;
-    struct drm_mode_modeinfo mode;
-};
-
 static struct drm_mode_crtc *drm_mode_get_crtc(
     struct arena *arena,
     i32 fd,
     u32 crtc_id
 ) {
-    struct arena temp_arena = *arena;
+    struct arena_checkpoint checkpoint = arena_save(arena);
     struct drm_mode_crtc *crtc = 0;
 
-    crtc = alloc(&temp_arena, sizeof(*crtc));
+    crtc = alloc(arena, sizeof(*crtc));
     if (crtc == 0) {
         return 0;
     }
@@ -811,10 +523,10 @@ static struct drm_mode_crtc *drm_mode_get_crtc(
         (char *)crtc
     );
     if (error != 0) {
+        arena_restore(arena, checkpoint);
         return 0;
     }
 
-    *arena = temp_arena;
     return crtc;
 }
 
@@ -838,14 +550,6 @@ static i32 drm_mode_set_crtc(
     );
 }
 
-struct drm_mode_crtc_page_flip {
-    u32 crtc_id;
-    u32 fb_id;
-    u32 flags;
-    u32 reserved;
-    void *user_data;
-};
-
 enum drm_mode_page_flip {
     DRM_MODE_PAGE_FLIP_EVENT = 1,
 };
@@ -868,28 +572,48 @@ static i32 drm_mode_crtc_page_flip(i32 fd, u32 crtc_id, u32 fb_id) {
     );
 }
 
-struct drm_event {
-    u32 type;
-    u32 length;
-};
+static i32 drm_mode_dirty_fb(
+    i32 fd,
+    u32 fb_id,
+    struct drm_clip_rect *clips,
+    u32 clips_len
+) {
+    struct drm_mode_fb_dirty_cmd dirty = {
+        .fb_id = fb_id,
+        .num_clips = clips_len,
+        .clips_ptr = (u64)clips,
+    };
+
+    return ioctl(
+        fd,
+        IOCTL_RDWR,
+        IOCTL_DRM,
+        DRM_IOCTL_MODE_DIRTYFB,
+        sizeof(dirty),
+        (char *)&dirty
+    );
+}
 
-enum drm_event_type {
-    DRM_EVENT_TYPE_FLIP_COMPLETE = 2,
+struct display_flip {
+    i64 time_ns;
+    u32 sequence;
 };
 
-static i32 drm_mode_handle_events(i32 fd, struct arena temp_arena) {
+static i32 drm_mode_parse_events(
+    char *buffer,
+    i64 len,
+    struct display_flip *flip
+) {
     i32 flip_complete = 0;
 
-    void *buffer = alloc(&temp_arena, 4096);
-    i64 len = read(fd, buffer, 4096);
-    if (len < 0) {
-        return (i32)len;
-    }
-
     i64 i = 0;
     while (i < len) {
-        struct drm_event *e = (struct drm_event *)(void *)((char *)buffer + i);
+        struct drm_event *e = (struct drm_event *)(void *)(buffer + i);
         if (e->type == DRM_EVENT_TYPE_FLIP_COMPLETE) {
+            struct drm_event_vblank *vblank = (void *)e;
+            flip->time_ns = (i64)vblank->tv_sec * 1000L * 1000L * 1000L +
+                (i64)vblank->tv_usec * 1000L;
+            flip->sequence = vblank->sequence;
             flip_complete = 1;
         }
         i += e->length;
@@ -898,337 +622,2210 @@ static i32 drm_mode_handle_events(i32 fd, struct arena temp_arena) {
     return flip_complete;
 }
 
-enum color {
-    COLOR_BLUE = 0x0000ff,
-    COLOR_GRAY = 0xededed,
-};
+static i32 drm_mode_handle_events(
+    i32 fd,
+    struct arena *scratch,
+    struct display_flip *flip
+) {
+    char *buffer = alloc_uninit(scratch, 4096);
+    if (buffer == 0) {
+        return -1;
+    }
+    i64 len = read(fd, buffer, 4096);
+    if (len < 0) {
+        return (i32)len;
+    }
+    return drm_mode_parse_events(buffer, len, flip);
+}
 
-struct game_state {
-    i32 x;
-    i32 y;
-    i32 vx;
-    i32 vy;
-    i32 nvx;
-    i32 nvy;
-    i32 nnvx;
-    i32 nnvy;
-    i32 dead;
-    i64 steps;
-    i64 timestep;
-    char board[90 * 90];
+struct frame_stats {
+    struct histogram flip_interval;
+    struct histogram render;
+    struct histogram missed_vblanks;
+    struct histogram input_latency;
+    struct histogram tick_to_flip;
+    struct histogram dirty_saved;
+    struct histogram tick_lag;
+    struct histogram bot_think;
+    struct histogram bot_depth;
+    struct histogram mcts_rate;
+
+    i32 flips;
+    struct display_flip last_flip;
+
+    i64 drawn_press_ns[8];
+    i32 drawn_press_len;
+    i64 shown_press_ns[8];
+    i32 shown_press_len;
+
+    i64 drawn_tick_ns;
+    i64 shown_tick_ns;
+
+    struct syscall_stats *syscalls;
+    struct arena *arena;
+    struct arena *scratch;
 };
 
-static void clear_game(struct game_state *state) {
-    state->x = 15;
-    state->y = 45;
-    state->vx = 1;
-    state->vy = 0;
-    state->nvx = state->vx;
-    state->nvy = state->vy;
-    state->nnvx = state->vx;
-    state->nnvy = state->vy;
-    state->dead = 0;
-
-    state->timestep = 66L * 1000L * 1000L;
-    state->steps = 0;
+static void frame_stats_flip(
+    struct frame_stats *stats,
+    struct display_flip *flip
+) {
+    if (stats->flips > 0) {
+        histogram_record(
+            &stats->flip_interval,
+            (u64)(flip->time_ns - stats->last_flip.time_ns)
+        );
+        u32 vblanks = flip->sequence - stats->last_flip.sequence;
+        histogram_record(
+            &stats->missed_vblanks,
+            (vblanks > 0) ? vblanks - 1 : 0
+        );
+    }
+    stats->flips += 1;
+    stats->last_flip = *flip;
 
-    for (u64 i = 0; i < sizeof(state->board); ++i) {
-        state->board[i] = 0;
+    for (i32 i = 0; i < stats->shown_press_len; ++i) {
+        histogram_record(
+            &stats->input_latency,
+            (u64)(flip->time_ns - stats->shown_press_ns[i])
+        );
     }
+    stats->shown_press_len = 0;
 
-    state->board[state->y * 90 + state->x] = 1;
+    if (stats->shown_tick_ns != 0) {
+        histogram_record(
+            &stats->tick_to_flip,
+            (u64)(flip->time_ns - stats->shown_tick_ns)
+        );
+        stats->shown_tick_ns = 0;
+    }
 }
 
-static void update_game(struct game_state *state) {
-    state->y += state->vy;
-    state->x += state->vx;
-    state->vx = state->nvx;
-    state->vy = state->nvy;
-    state->nvx = state->nnvx;
-    state->nvy = state->nnvy;
-
-    if (
-        state->board[state->y * 90 + state->x] != 0 ||
-        state->x > 89 ||
-        state->x < 0 ||
-        state->y > 89 ||
-        state->y < 0
-    ) {
-        state->dead = 1;
-    } else {
-        state->board[state->y * 90 + state->x] = 1;
+static void frame_stats_draw(struct frame_stats *stats, i64 render_ns) {
+    histogram_record(&stats->render, (u64)render_ns);
+    for (i32 i = 0; i < stats->drawn_press_len; ++i) {
+        if (stats->shown_press_len < 8) {
+            stats->shown_press_ns[stats->shown_press_len] =
+                stats->drawn_press_ns[i];
+            stats->shown_press_len += 1;
+        }
     }
+    stats->drawn_press_len = 0;
 
-    state->steps += 1;
-    if (state->steps >= (1000L * 1000L * 1000L) / state->timestep) {
-        if (state->timestep > 16L * 1000L * 1000L) {
-            state->timestep -= 2L * 1000L * 1000L;
-        }
-        state->steps = 0;
+    if (stats->shown_tick_ns == 0) {
+        stats->shown_tick_ns = stats->drawn_tick_ns;
     }
+    stats->drawn_tick_ns = 0;
 }
 
-static void draw_game(
-    struct drm_mode_dumb_buffer *buf,
-    struct game_state *state,
-    u32 x,
-    u32 y,
-    u32 scale
-) {
-    for (u32 i = 0; i < 90; ++i) {
-        for (u32 yoff = 0; yoff < scale; ++yoff) {
-            u32 cy = cy = y + i * scale + yoff;
-            for (u32 j = 0; j < 90; ++j) {
-                for (u32 xoff = 0; xoff < scale; ++xoff) {
-                    u32 cx = x + j * scale + xoff;
-                    u32 pixel_index = cy * buf->stride + cx;
-                    if (state->board[i * 90 + j] == 0) {
-                        buf->map[pixel_index] = (u32)COLOR_GRAY;
-                    } else {
-                        buf->map[pixel_index] = (u32)COLOR_BLUE;
-                    }
-                }
-            }
-        }
+static void frame_stats_tick(struct frame_stats *stats, i64 tick_ns) {
+    if (stats->drawn_tick_ns == 0) {
+        stats->drawn_tick_ns = tick_ns;
     }
 }
 
-static void draw_partial(
-    struct drm_mode_dumb_buffer *buf,
+static void frame_stats_update(
+    struct frame_stats *stats,
     struct game_state *state,
-    u32 x,
-    u32 y,
-    u32 scale,
-    u32 partial
+    i32 vx,
+    i32 vy,
+    i64 press_ns
 ) {
-    if (state->y == 0 && state->vy < 0) {
+    if (state->vx == vx && state->vy == vy) {
         return;
     }
-    if (state->y == 89 && state->vy > 0) {
-        return;
+    if (press_ns != 0 && stats->drawn_press_len < 8) {
+        stats->drawn_press_ns[stats->drawn_press_len] = press_ns;
+        stats->drawn_press_len += 1;
     }
-    if (state->x == 0 && state->vx < 0) {
-        return;
+}
+
+static void frame_stats_clear(struct frame_stats *stats) {
+    stats->drawn_press_len = 0;
+}
+
+static void frame_stats_merge(
+    struct frame_stats *stats,
+    struct frame_stats *other
+) {
+    histogram_merge(&stats->flip_interval, &other->flip_interval);
+    histogram_merge(&stats->render, &other->render);
+    histogram_merge(&stats->missed_vblanks, &other->missed_vblanks);
+    histogram_merge(&stats->input_latency, &other->input_latency);
+    histogram_merge(&stats->tick_to_flip, &other->tick_to_flip);
+    histogram_merge(&stats->dirty_saved, &other->dirty_saved);
+    histogram_clear(&other->flip_interval);
+    histogram_clear(&other->render);
+    histogram_clear(&other->missed_vblanks);
+    histogram_clear(&other->input_latency);
+    histogram_clear(&other->tick_to_flip);
+    histogram_clear(&other->dirty_saved);
+}
+
+struct syscall_name {
+    u64 key;
+    char *name;
+};
+
+static struct syscall_name syscall_names[] = {
+    { 0, "read" },
+    { 1, "write" },
+    { 2, "open" },
+    { 3, "close" },
+    { 7, "poll" },
+    { 9, "mmap" },
+    { 11, "munmap" },
+    { 14, "rt_sigprocmask" },
+    { 16, "ioctl" },
+    { 28, "madvise" },
+    { 78, "getdents" },
+    { 157, "prctl" },
+    { 202, "futex" },
+    { 204, "sched_getaffinity" },
+    { 228, "clock_gettime" },
+    { 232, "epoll_wait" },
+    { 233, "epoll_ctl" },
+    { 257, "openat" },
+    { 283, "timerfd_create" },
+    { 286, "timerfd_settime" },
+    { 289, "signalfd4" },
+    { 291, "epoll_create1" },
+    { 425, "io_uring_setup" },
+    { 426, "io_uring_enter" },
+};
+
+static struct syscall_name ioctl_names[] = {
+    { (IOCTL_EV << 8) | EV_IOCTL_GET_BIT, "EVIOCGBIT" },
+    { (IOCTL_EV << 8) | EV_IOCTL_GET_KEY, "EVIOCGBIT(EV_KEY)" },
+    { (IOCTL_EV << 8) | EV_IOCTL_GRAB, "EVIOCGRAB" },
+    { (IOCTL_EV << 8) | EV_IOCTL_SET_CLOCK_ID, "EVIOCSCLOCKID" },
+    { (IOCTL_DRM << 8) | DRM_IOCTL_MODE_GET_RESOURCES, "MODE_GETRESOURCES" },
+    { (IOCTL_DRM << 8) | DRM_IOCTL_MODE_GET_CONNECTOR, "MODE_GETCONNECTOR" },
+    { (IOCTL_DRM << 8) | DRM_IOCTL_MODE_GET_ENCODER, "MODE_GETENCODER" },
+    { (IOCTL_DRM << 8) | DRM_IOCTL_MODE_ADD_FB, "MODE_ADDFB" },
+    { (IOCTL_DRM << 8) | DRM_IOCTL_MODE_CREATE_DUMB, "MODE_CREATE_DUMB" },
+    { (IOCTL_DRM << 8) | DRM_IOCTL_MODE_MAP_DUMB, "MODE_MAP_DUMB" },
+    { (IOCTL_DRM << 8) | DRM_IOCTL_MODE_GET_CRTC, "MODE_GETCRTC" },
+    { (IOCTL_DRM << 8) | DRM_IOCTL_MODE_SET_CRTC, "MODE_SETCRTC" },
+    { (IOCTL_DRM << 8) | DRM_IOCTL_MODE_PAGE_FLIP, "MODE_PAGE_FLIP" },
+    { (IOCTL_DRM << 8) | DRM_IOCTL_MODE_DIRTYFB, "MODE_DIRTYFB" },
+};
+
+static char *syscall_name_find(
+    struct syscall_name *names,
+    u64 names_len,
+    u64 key
+) {
+    for (u64 i = 0; i < names_len; ++i) {
+        if (names[i].key == key) {
+            return names[i].name;
+        }
     }
-    if (state->x == 89 && state->vx > 0) {
-        return;
+    return 0;
+}
+
+static void print_hundredths(struct print_buffer *out, u64 value) {
+    print_u64(out, value / 100);
+    print_char(out, '.');
+    print_char(out, (char)('0' + value / 10 % 10));
+    print_char(out, (char)('0' + value % 10));
+}
+
+static void syscall_counter_print(
+    struct print_buffer *out,
+    char *kind,
+    char *name,
+    u64 key,
+    struct syscall_counter *counter,
+    u64 ns_scale,
+    u64 frames
+) {
+    u64 ns = (counter->cycles * ns_scale) >> 20;
+    print_str(out, kind);
+    print_char(out, ' ');
+    if (name != 0) {
+        print_str(out, name);
+    } else {
+        print_u64(out, key);
     }
-    for (u32 yoff = 0; yoff < scale; ++yoff) {
-        if (state->vy > 0 && yoff >= partial) {
+    print_str(out, ": calls=");
+    print_u64(out, counter->calls);
+    if (frames != 0) {
+        print_str(out, " per_frame=");
+        print_hundredths(out, counter->calls * 100 / frames);
+    }
+    print_str(out, " mean_ns=");
+    print_u64(out, ns / counter->calls);
+    print_str(out, " total_ns=");
+    print_u64(out, ns);
+    print_char(out, '\n');
+}
+
+static void syscall_stats_print(
+    struct print_buffer *out,
+    struct syscall_stats *stats,
+    u64 frames
+) {
+    syscall_stats_calibrate(stats);
+    for (u64 i = 0; i < SYSCALL_STATS_SYSCALLS; ++i) {
+        struct syscall_counter counter = stats->syscalls[i];
+        if (counter.calls == 0) {
             continue;
         }
-        if (state->vy < 0 && yoff < scale - partial) {
+        syscall_counter_print(
+            out,
+            "syscall",
+            syscall_name_find(
+                syscall_names,
+                sizeof(syscall_names) / sizeof(*syscall_names),
+                i
+            ),
+            i,
+            &counter,
+            stats->ns_scale,
+            frames
+        );
+    }
+    for (u64 i = 0; i < SYSCALL_STATS_IOCTLS; ++i) {
+        struct syscall_counter counter = stats->ioctls[i];
+        if (counter.key == 0 || counter.calls == 0) {
             continue;
         }
-        u32 cy = cy = y + (u32)(state->y + state->vy) * scale + yoff;
-        for (u32 xoff = 0; xoff < scale; ++xoff) {
-            if (state->vx > 0 && xoff >= partial) {
-                continue;
-            }
-            if (state->vx < 0 && xoff < scale - partial) {
-                continue;
-            }
-            u32 cx = x + (u32)(state->x + state->vx) * scale + xoff;
-            u32 pixel_index = cy * buf->stride + cx;
-            buf->map[pixel_index] = (u32)COLOR_BLUE;
-        }
+        syscall_counter_print(
+            out,
+            "ioctl",
+            syscall_name_find(
+                ioctl_names,
+                sizeof(ioctl_names) / sizeof(*ioctl_names),
+                counter.key & 0xffff
+            ),
+            counter.key,
+            &counter,
+            stats->ns_scale,
+            frames
+        );
     }
 }
 
-enum main_error {
-    MAIN_ERROR_NONE = 0,
-    MAIN_ERROR_MMAP,
-    MAIN_ERROR_OPEN_CARD0,
-    MAIN_ERROR_DRM_GET_RESOURCES,
-    MAIN_ERROR_DRM_FIND_CONNECTOR,
-    MAIN_ERROR_DRM_GET_ENCODER,
-    MAIN_ERROR_DRM_CREATE_DUMB_BUFFER,
-    MAIN_ERROR_DRM_GET_CRTC,
-    MAIN_ERROR_DRM_SET_CRTC,
-    MAIN_ERROR_DRM_HANDLE_EVENTS,
-    MAIN_ERROR_DRM_PAGE_FLIP,
-    MAIN_ERROR_OPEN_KEYBOARD,
-    MAIN_ERROR_READ_KEYBOARD,
-    MAIN_ERROR_CLOCK_GETTIME,
-    MAIN_ERROR_POLL,
-};
+static void arena_stats_print(
+    struct print_buffer *out,
+    char *name,
+    struct arena *arena
+) {
+    print_str(out, name);
+    print_str(out, " (bytes): used=");
+    print_u64(out, (u64)(arena->start - arena->base));
+    print_str(out, " high=");
+    print_u64(out, (u64)(arena->high - arena->base));
+    print_str(out, " size=");
+    print_u64(out, (u64)(arena->end - arena->base));
+    print_str(out, " failures=");
+    print_u64(out, arena->failures);
+    print_char(out, '\n');
+}
 
-i32 main(i32 argc, char **argv) {
-    (void)argc;
-    (void)argv;
-    i64 arena_size = 2000 * 4096;
-    char *mem = mmap(
-        0,
-        arena_size,
-        PROT_WRITE | PROT_READ,
-        MAP_SHARED | MAP_ANONYMOUS,
-        -1,
-        0
-    );
-    if (mem == 0) {
-        return MAIN_ERROR_MMAP;
+static void frame_stats_print(struct frame_stats *stats) {
+    struct print_buffer out;
+    out.fd = STDERR;
+    out.len = 0;
+    histogram_print(&out, "flip interval", "ns", &stats->flip_interval);
+    histogram_print(&out, "render", "ns", &stats->render);
+    histogram_print(&out, "missed vblanks", "per flip", &stats->missed_vblanks);
+    histogram_print(&out, "input latency", "ns", &stats->input_latency);
+    histogram_print(&out, "tick to flip", "ns", &stats->tick_to_flip);
+    if (stats->dirty_saved.count != 0) {
+        histogram_print(
+            &out,
+            "dirty fb saved",
+            "bytes per frame",
+            &stats->dirty_saved
+        );
     }
+    histogram_print(&out, "tick lag", "ns", &stats->tick_lag);
+    if (stats->bot_think.count != 0) {
+        histogram_print(&out, "bot think", "ns", &stats->bot_think);
+    }
+    if (stats->bot_depth.count != 0) {
+        histogram_print(&out, "bot depth", "plies", &stats->bot_depth);
+    }
+    if (stats->mcts_rate.count != 0) {
+        histogram_print(&out, "mcts rollouts", "per s", &stats->mcts_rate);
+    }
+    if (stats->syscalls != 0) {
+        syscall_stats_print(&out, stats->syscalls, stats->render.count);
+    }
+    if (stats->arena != 0) {
+        arena_stats_print(&out, "arena", stats->arena);
+    }
+    if (stats->scratch != 0) {
+        arena_stats_print(&out, "frame scratch", stats->scratch);
+    }
+    print_flush(&out);
+}
+
+static void bot_steer(
+    struct bot *bot,
+    struct game_state *state,
+    struct frame_stats *stats
+) {
+    i32 x = state->x + state->vx;
+    i32 y = state->y + state->vy;
+    if (
+        x < 0 ||
+        x >= state->width ||
+        y < 0 ||
+        y >= state->height ||
+        board_test(board_row(state, y), x)
+    ) {
+        return;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    i32 vx, vy;
+    i32 depth = bot_choose(
+        bot,
+        state->board,
+        x,
+        y,
+        state->vx,
+        state->vy,
+        0,
+        0,
+        &vx,
+        &vy
+    );
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    histogram_record(&stats->bot_think, (u64)time_since_ns(&end, &start));
+    histogram_record(&stats->bot_depth, (u64)depth);
+
+    queue_turn(state, vx, vy);
+}
+
+static void mcts_steer(
+    struct mcts *mcts,
+    struct game_state *state,
+    struct frame_stats *stats
+) {
+    i32 x = state->x + state->vx;
+    i32 y = state->y + state->vy;
+    if (
+        x < 0 ||
+        x >= state->width ||
+        y < 0 ||
+        y >= state->height ||
+        board_test(board_row(state, y), x)
+    ) {
+        return;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    i32 vx, vy;
+    u64 rollouts = mcts_choose(
+        mcts,
+        state->board,
+        x,
+        y,
+        state->vx,
+        state->vy,
+        &vx,
+        &vy
+    );
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    i64 elapsed = time_since_ns(&end, &start);
+    histogram_record(&stats->bot_think, (u64)elapsed);
+    if (elapsed > 0) {
+        histogram_record(
+            &stats->mcts_rate,
+            rollouts * 1000UL * 1000UL * 1000UL / (u64)elapsed
+        );
+    }
+
+    queue_turn(state, vx, vy);
+}
+
+enum main_error {
+    MAIN_ERROR_NONE = 0,
+    MAIN_ERROR_MMAP,
+    MAIN_ERROR_OPEN_CARD0,
+    MAIN_ERROR_DRM_GET_RESOURCES,
+    MAIN_ERROR_DRM_FIND_CONNECTOR,
+    MAIN_ERROR_DRM_GET_ENCODER,
+    MAIN_ERROR_DRM_CREATE_DUMB_BUFFER,
+    MAIN_ERROR_DRM_GET_CRTC,
+    MAIN_ERROR_DRM_SET_CRTC,
+    MAIN_ERROR_DRM_HANDLE_EVENTS,
+    MAIN_ERROR_DRM_PAGE_FLIP,
+    MAIN_ERROR_OPEN_KEYBOARD,
+    MAIN_ERROR_READ_KEYBOARD,
+    MAIN_ERROR_CLOCK_GETTIME,
+    MAIN_ERROR_POLL,
+    MAIN_ERROR_ARGS,
+    MAIN_ERROR_RENDERER_INIT,
+    MAIN_ERROR_TIMERFD,
+    MAIN_ERROR_SIGNALFD,
+    MAIN_ERROR_ALLOC,
+    MAIN_ERROR_RECORD,
+    MAIN_ERROR_REPLAY,
+    MAIN_ERROR_BOARD,
+    MAIN_ERROR_MCTS,
+    MAIN_ERROR_THREAD,
+    MAIN_ERROR_EPOLL,
+};
+
+static i32 str_equal(char *a, char *b) {
+    while (*a != 0 && *a == *b) {
+        a += 1;
+        b += 1;
+    }
+    return *a == *b;
+}
+
+enum display_backend {
+    DISPLAY_BACKEND_DRM = 0,
+    DISPLAY_BACKEND_OFFSCREEN,
+};
+
+struct display {
+    enum display_backend backend;
+    i32 fd;
+    u32 width;
+    u32 height;
+    enum pixel_format format;
+    u32 buffers_len;
+
+    u32 connector_id;
+    struct drm_mode_crtc *crtc;
+
+    i32 dirty_fb;
+
+    i64 refresh_ns;
+    struct timespec start;
+    i64 vblank_ns;
+};
+
+static i32 display_open_drm(struct display *display, struct arena *arena) {
+    display->backend = DISPLAY_BACKEND_DRM;
+    display->buffers_len = 0;
+    display->dirty_fb = 1;
+
+    display->fd = open("/dev/dri/card0", O_RDWR, 0);
+    if (display->fd < 0) {
+        return MAIN_ERROR_OPEN_CARD0;
+    }
+
+    struct drm_mode_resources *res = drm_mode_get_resources(
+        arena,
+        display->fd
+    );
+    if (res == 0) {
+        return MAIN_ERROR_DRM_GET_RESOURCES;
+    }
+
+    u32 conn_index;
+    struct drm_mode_connector *conn = 0;
+    for (conn_index = 0; conn_index < res->connectors_len; ++conn_index) {
+        conn = drm_mode_get_connector(
+            arena,
+            display->fd,
+            res->connectors[conn_index]
+        );
+        if (conn == 0) {
+            continue;
+        }
+        if (conn->connection == DRM_MODE_CONNECTED && conn->modes_len != 0) {
+            break;
+        }
+    }
+    if (conn_index == res->connectors_len || conn == 0) {
+        return MAIN_ERROR_DRM_FIND_CONNECTOR;
+    }
+
+    struct drm_mode_encoder *enc = drm_mode_get_encoder(
+        arena,
+        display->fd,
+        conn->encoder_id
+    );
+    if (enc == 0) {
+        return MAIN_ERROR_DRM_GET_ENCODER;
+    }
+
+    display->crtc = drm_mode_get_crtc(arena, display->fd, enc->crtc_id);
+    if (display->crtc == 0) {
+        return MAIN_ERROR_DRM_GET_CRTC;
+    }
+
+    display->crtc->mode = conn->modes[0];
+    display->connector_id = conn->connector_id;
+    display->width = conn->modes[0].hdisplay;
+    display->height = conn->modes[0].vdisplay;
+    display->refresh_ns = (1000L * 1000L * 1000L) / 60;
+    if (conn->modes[0].vrefresh != 0) {
+        display->refresh_ns =
+            (1000L * 1000L * 1000L) / (i64)conn->modes[0].vrefresh;
+    }
+
+    return MAIN_ERROR_NONE;
+}
+
+static i32 display_open_offscreen(
+    struct display *display,
+    u32 width,
+    u32 height,
+    u32 refresh_hz
+) {
+    display->backend = DISPLAY_BACKEND_OFFSCREEN;
+    display->buffers_len = 0;
+    display->dirty_fb = 1;
+    display->width = width;
+    display->height = height;
+    display->refresh_ns = (1000L * 1000L * 1000L) / (i64)refresh_hz;
+
+    i32 error = clock_gettime(CLOCK_MONOTONIC, &display->start);
+    if (error != 0) {
+        return MAIN_ERROR_CLOCK_GETTIME;
+    }
+
+    display->fd = timerfd_create(CLOCK_MONOTONIC, 0);
+    if (display->fd < 0) {
+        return MAIN_ERROR_TIMERFD;
+    }
+
+    return MAIN_ERROR_NONE;
+}
+
+static u32 display_bpp(struct display *display) {
+    if (display->format == PIXEL_FORMAT_RGB565) {
+        return 16;
+    }
+    return 32;
+}
+
+static struct drm_mode_dumb_buffer *memory_buffer_create(
+    struct arena *arena,
+    u32 width,
+    u32 height,
+    u32 bpp
+) {
+    u32 pitch = (width * bpp / 8 + 63) & ~63U;
+    u64 size = (u64)pitch * height;
+    u32 *mem = mmap(
+        0,
+        (i64)size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+    if (mem == 0) {
+        return 0;
+    }
+
+    struct drm_mode_dumb_buffer *buf = alloc(arena, sizeof(*buf));
+    if (buf == 0) {
+        return 0;
+    }
+    buf->width = width;
+    buf->height = height;
+    buf->stride = pitch / sizeof(u32);
+    buf->size = size / sizeof(u32);
+    buf->handle = 0;
+    buf->fb_id = 0;
+    buf->map = mem;
+
+    return buf;
+}
+
+static struct drm_mode_dumb_buffer *display_create_buffer(
+    struct display *display,
+    struct arena *arena
+) {
+    u32 bpp = display_bpp(display);
+    if (display->backend == DISPLAY_BACKEND_DRM) {
+        return drm_mode_create_dumb_buffer(
+            arena,
+            display->fd,
+            display->width,
+            display->height,
+            bpp,
+            bpp == 32 ? 24 : bpp
+        );
+    }
+
+    struct drm_mode_dumb_buffer *buf = memory_buffer_create(
+        arena,
+        display->width,
+        display->height,
+        bpp
+    );
+    if (buf == 0) {
+        return 0;
+    }
+    display->buffers_len += 1;
+    buf->handle = display->buffers_len;
+    buf->fb_id = display->buffers_len;
+
+    return buf;
+}
+
+static i32 display_set_buffer(
+    struct display *display,
+    struct drm_mode_dumb_buffer *buf
+) {
+    if (display->backend == DISPLAY_BACKEND_DRM) {
+        return drm_mode_set_crtc(
+            display->fd,
+            display->crtc,
+            &display->connector_id,
+            1,
+            buf->fb_id
+        );
+    }
+    return 0;
+}
+
+static i32 display_flip(
+    struct display *display,
+    struct drm_mode_dumb_buffer *buf
+) {
+    if (display->backend == DISPLAY_BACKEND_DRM) {
+        return drm_mode_crtc_page_flip(
+            display->fd,
+            display->crtc->crtc_id,
+            buf->fb_id
+        );
+    }
+
+    struct timespec now;
+    i32 error = clock_gettime(CLOCK_MONOTONIC, &now);
+    if (error != 0) {
+        return error;
+    }
+
+    i64 since_start = time_since_ns(&now, &display->start);
+    i64 vblank = (since_start / display->refresh_ns + 1) * display->refresh_ns;
+    display->vblank_ns = vblank;
+    struct itimerspec timer = {
+        .value = {
+            .sec = display->start.sec + vblank / (1000L * 1000L * 1000L),
+            .nsec = display->start.nsec + vblank % (1000L * 1000L * 1000L),
+        },
+    };
+    if (timer.value.nsec >= 1000L * 1000L * 1000L) {
+        timer.value.sec += 1;
+        timer.value.nsec -= 1000L * 1000L * 1000L;
+    }
+
+    return timerfd_settime(display->fd, TFD_TIMER_ABSTIME, &timer);
+}
+
+static void display_dirty(
+    struct display *display,
+    struct drm_mode_dumb_buffer *buf,
+    struct board_damage *damage,
+    struct frame_stats *stats
+) {
+    if (display->dirty_fb) {
+        u64 frame_bytes = (u64)buf->stride * buf->height * sizeof(u32);
+        u64 dirty_bytes = frame_bytes;
+        if (!damage->clips_full) {
+            dirty_bytes = 0;
+            for (i32 i = 0; i < damage->clips_len; ++i) {
+                struct drm_clip_rect *clip = &damage->clips[i];
+                dirty_bytes += (u64)(clip->x2 - clip->x1) *
+                    (u64)(clip->y2 - clip->y1) * display_bpp(display) / 8;
+            }
+        }
+
+        i32 error = 0;
+        if (
+            display->backend == DISPLAY_BACKEND_DRM &&
+            (damage->clips_full || damage->clips_len > 0)
+        ) {
+            error = drm_mode_dirty_fb(
+                display->fd,
+                buf->fb_id,
+                damage->clips,
+                damage->clips_full ? 0 : (u32)damage->clips_len
+            );
+        }
+        if (error != 0) {
+            display->dirty_fb = 0;
+        } else {
+            histogram_record(&stats->dirty_saved, frame_bytes - dirty_bytes);
+        }
+    }
+    board_damage_submitted(damage);
+}
+
+static i32 offscreen_flip_event(
+    struct display *display,
+    u64 expirations,
+    struct display_flip *flip
+) {
+    flip->time_ns = display->start.sec * 1000L * 1000L * 1000L +
+        display->start.nsec + display->vblank_ns;
+    flip->sequence = (u32)(display->vblank_ns / display->refresh_ns);
+    return expirations > 0;
+}
+
+static i32 display_parse_events(
+    struct display *display,
+    char *bytes,
+    i64 len,
+    struct display_flip *flip
+) {
+    if (display->backend == DISPLAY_BACKEND_DRM) {
+        return drm_mode_parse_events(bytes, len, flip);
+    }
+
+    u64 expirations = 0;
+    if (len >= (i64)sizeof(expirations)) {
+        expirations = *(u64 *)(void *)bytes;
+    }
+    return offscreen_flip_event(display, expirations, flip);
+}
+
+static i32 display_handle_events(
+    struct display *display,
+    struct arena *scratch,
+    struct display_flip *flip
+) {
+    if (display->backend == DISPLAY_BACKEND_DRM) {
+        return drm_mode_handle_events(display->fd, scratch, flip);
+    }
+
+    u64 expirations;
+    i64 len = read(display->fd, (char *)&expirations, sizeof(expirations));
+    if (len < 0) {
+        return (i32)len;
+    }
+    return offscreen_flip_event(display, expirations, flip);
+}
+
+enum render_thread_layout {
+    RENDER_SNAPSHOTS = 8,
+    RENDER_STACK_SIZE = 64 * 1024,
+    RENDER_SCRATCH_SIZE = 4 * 4096,
+};
+
+struct shadow_buffer {
+    struct drm_mode_dumb_buffer *buf;
+    struct board_damage damage;
+    struct board_damage *targets;
+    i32 targets_len;
+};
+
+static i64 draw_frame(
+    struct renderer *renderer,
+    struct shadow_buffer *shadow,
+    struct drm_mode_dumb_buffer *buf,
+    struct board_damage *damage,
+    struct game_state *state,
+    u32 partial
+) {
+    struct timespec render_start, render_end;
+    clock_gettime(CLOCK_MONOTONIC, &render_start);
+    if (shadow == 0) {
+        draw_damage(renderer, buf, damage, state);
+        draw_partial_damage(renderer, buf, damage, state, partial);
+    } else {
+        draw_damage(renderer, shadow->buf, &shadow->damage, state);
+        draw_partial_damage(
+            renderer,
+            shadow->buf,
+            &shadow->damage,
+            state,
+            partial
+        );
+        for (i32 i = 0; i < shadow->targets_len; ++i) {
+            board_damage_merge(&shadow->targets[i], &shadow->damage);
+        }
+        board_damage_submitted(&shadow->damage);
+        copy_damage(renderer, buf, shadow->buf, damage);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &render_end);
+    return time_since_ns(&render_end, &render_start);
+}
+
+struct render_snapshot {
+    struct game_state state;
+    i64 tick_ns;
+    i64 press_ns[8];
+    i32 press_len;
+};
+
+struct render_thread {
+    struct display *display;
+    struct renderer *renderer;
+    struct drm_mode_dumb_buffer **bufs;
+    struct board_damage *damage;
+    struct shadow_buffer *shadow;
+    struct frame_stats *shared_stats;
+    struct frame_stats *stats;
+    struct arena scratch;
+    u32 buf_index;
+    i64 frames_left;
+    i32 error;
+
+    struct render_snapshot snapshots[RENDER_SNAPSHOTS];
+    u32 head;
+    u32 tail;
+
+    u32 quit;
+    u32 stopped;
+    u32 print_requests;
+    u32 print_acks;
+    u32 printed;
+    struct thread thread;
+};
+
+static i32 render_thread_init(
+    struct render_thread *render,
+    struct arena *arena,
+    struct game_state *state
+) {
+    for (i32 i = 0; i < RENDER_SNAPSHOTS; ++i) {
+        render->snapshots[i].state.board = alloc(
+            arena,
+            state->height * state->row_words * (i64)sizeof(u64)
+        );
+        if (render->snapshots[i].state.board == 0) {
+            return -1;
+        }
+    }
+    render->stats = alloc(arena, sizeof(*render->stats));
+    if (render->stats == 0) {
+        return -1;
+    }
+    return arena_split(arena, &render->scratch, RENDER_SCRATCH_SIZE);
+}
+
+static i32 render_publish(
+    struct render_thread *render,
+    struct game_state *state,
+    i64 tick_ns,
+    struct frame_stats *stats
+) {
+    u32 head = render->head;
+    u32 tail = __atomic_load_n(&render->tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= RENDER_SNAPSHOTS) {
+        return 0;
+    }
+
+    struct render_snapshot *snapshot = &render->snapshots[
+        head % RENDER_SNAPSHOTS
+    ];
+    u64 *board = snapshot->state.board;
+    snapshot->state = *state;
+    snapshot->state.board = board;
+    memcpy(
+        board,
+        state->board,
+        (u64)(state->height * state->row_words) * sizeof(u64)
+    );
+    snapshot->tick_ns = tick_ns;
+    snapshot->press_len = stats->drawn_press_len;
+    for (i32 i = 0; i < stats->drawn_press_len; ++i) {
+        snapshot->press_ns[i] = stats->drawn_press_ns[i];
+    }
+    stats->drawn_press_len = 0;
+
+    __atomic_store_n(&render->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+static void render_thread_main(void *arg) {
+    struct render_thread *render = arg;
+    struct frame_stats *stats = render->stats;
+    struct render_snapshot *snapshot = 0;
+    u32 seen = 0;
+    while (!__atomic_load_n(&render->quit, __ATOMIC_ACQUIRE)) {
+        arena_reset(&render->scratch);
+        struct display_flip flip;
+        i32 result = display_handle_events(
+            render->display,
+            &render->scratch,
+            &flip
+        );
+        if (result < 0) {
+            render->error = MAIN_ERROR_DRM_HANDLE_EVENTS;
+            break;
+        }
+        if (result == 0) {
+            continue;
+        }
+        frame_stats_flip(stats, &flip);
+
+        u32 head = __atomic_load_n(&render->head, __ATOMIC_ACQUIRE);
+        while (seen != head) {
+            snapshot = &render->snapshots[seen % RENDER_SNAPSHOTS];
+            frame_stats_tick(stats, snapshot->tick_ns);
+            for (i32 i = 0; i < snapshot->press_len; ++i) {
+                if (stats->drawn_press_len < 8) {
+                    stats->drawn_press_ns[stats->drawn_press_len] =
+                        snapshot->press_ns[i];
+                    stats->drawn_press_len += 1;
+                }
+            }
+            seen += 1;
+        }
+        __atomic_store_n(&render->tail, seen - 1, __ATOMIC_RELEASE);
+
+        struct game_state *state = &snapshot->state;
+        u32 buf_index = render->buf_index;
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        i64 since_tick = now.sec * 1000L * 1000L * 1000L + now.nsec -
+            snapshot->tick_ns;
+        u32 partial = render->renderer->scale - 1;
+        if (since_tick < state->timestep) {
+            partial = (u32)(
+                (since_tick * (i64)render->renderer->scale) / state->timestep
+            );
+        }
+        i64 render_ns = draw_frame(
+            render->renderer,
+            render->shadow,
+            render->bufs[buf_index],
+            &render->damage[buf_index],
+            state,
+            partial
+        );
+        frame_stats_draw(stats, render_ns);
+
+        display_dirty(
+            render->display,
+            render->bufs[buf_index],
+            &render->damage[buf_index],
+            stats
+        );
+        i32 error = display_flip(render->display, render->bufs[buf_index]);
+        if (error != 0) {
+            render->error = MAIN_ERROR_DRM_PAGE_FLIP;
+            break;
+        }
+        render->buf_index = buf_index ^ 1;
+
+        u32 requests = __atomic_load_n(
+            &render->print_requests,
+            __ATOMIC_ACQUIRE
+        );
+        if (requests != render->print_acks) {
+            frame_stats_merge(render->shared_stats, stats);
+            __atomic_store_n(&render->print_acks, requests, __ATOMIC_RELEASE);
+        }
+
+        if (render->frames_left > 0) {
+            render->frames_left -= 1;
+            if (render->frames_left == 0) {
+                break;
+            }
+        }
+    }
+
+    frame_stats_merge(render->shared_stats, stats);
+    __atomic_store_n(&render->stopped, 1, __ATOMIC_RELEASE);
+}
+
+enum event_loop_mode {
+    EVENT_LOOP_EPOLL = 0,
+    EVENT_LOOP_POLL,
+    EVENT_LOOP_URING,
+};
+
+enum event_loop_timing {
+    EVENT_LOOP_SPIN_NS = 100 * 1000,
+};
+
+enum event_loop_uring_layout {
+    EVENT_LOOP_URING_ENTRIES = 64,
+    EVENT_LOOP_TAG_SHIFT = 32,
+    EVENT_LOOP_TAG_FD = 0,
+    EVENT_LOOP_TAG_TIMEOUT = 1,
+    EVENT_LOOP_TAG_REMOVE = 2,
+};
+
+enum event_loop_error {
+    ETIME = 62,
+};
+
+enum event_loop_slot_kind {
+    EVENT_LOOP_SLOT_NONE = 0,
+    EVENT_LOOP_SLOT_READ,
+    EVENT_LOOP_SLOT_POLL,
+};
+
+struct event_loop_slot {
+    enum event_loop_slot_kind kind;
+    i32 posted;
+    i32 ready;
+    i32 result;
+    char *bytes;
+};
+
+struct event_loop {
+    enum event_loop_mode mode;
+    i32 epoll_fd;
+    i32 tick_fd;
+    i32 fds_len;
+
+    struct uring ring;
+    struct event_loop_slot *slots;
+    u32 read_size;
+    i32 timeout_posted;
+    i32 timeout_fired;
+    u32 timeout_generation;
+    i64 timeout_ns;
+    struct timespec timeout;
+};
+
+static i32 event_loop_init_uring(
+    struct event_loop *loop,
+    struct arena *arena,
+    struct pollfd *fds,
+    i32 reads_len,
+    u32 read_size
+) {
+    loop->slots = alloc(arena, loop->fds_len * (i64)sizeof(*loop->slots));
+    if (loop->slots == 0) {
+        return MAIN_ERROR_ALLOC;
+    }
+    for (i32 i = 0; i < loop->fds_len; ++i) {
+        struct event_loop_slot *slot = &loop->slots[i];
+        slot->kind = EVENT_LOOP_SLOT_NONE;
+        if (fds[i].fd < 0) {
+            continue;
+        }
+        slot->kind = EVENT_LOOP_SLOT_POLL;
+        if (i < reads_len) {
+            slot->kind = EVENT_LOOP_SLOT_READ;
+            slot->bytes = alloc(arena, read_size);
+            if (slot->bytes == 0) {
+                return MAIN_ERROR_ALLOC;
+            }
+        }
+    }
+    loop->read_size = read_size;
+    loop->timeout_posted = 0;
+    loop->timeout_fired = 0;
+    loop->timeout_generation = 0;
+
+    if (uring_init(&loop->ring, EVENT_LOOP_URING_ENTRIES) != 0) {
+        return MAIN_ERROR_EPOLL;
+    }
+    return MAIN_ERROR_NONE;
+}
+
+static i32 event_loop_init(
+    struct event_loop *loop,
+    struct arena *arena,
+    enum event_loop_mode mode,
+    struct pollfd *fds,
+    i32 fds_len,
+    i32 reads_len,
+    u32 read_size
+) {
+    loop->mode = mode;
+    loop->epoll_fd = -1;
+    loop->tick_fd = -1;
+    loop->fds_len = fds_len;
+    if (mode == EVENT_LOOP_POLL) {
+        return MAIN_ERROR_NONE;
+    }
+    if (mode == EVENT_LOOP_URING) {
+        struct arena_checkpoint checkpoint = arena_save(arena);
+        i32 error = event_loop_init_uring(
+            loop,
+            arena,
+            fds,
+            reads_len,
+            read_size
+        );
+        if (error == MAIN_ERROR_NONE) {
+            return MAIN_ERROR_NONE;
+        }
+        arena_restore(arena, checkpoint);
+        loop->mode = EVENT_LOOP_EPOLL;
+    }
+
+    loop->epoll_fd = epoll_create1(0);
+    if (loop->epoll_fd < 0) {
+        return MAIN_ERROR_EPOLL;
+    }
+    loop->tick_fd = timerfd_create(CLOCK_MONOTONIC, 0);
+    if (loop->tick_fd < 0) {
+        return MAIN_ERROR_TIMERFD;
+    }
+    prctl(PR_SET_TIMERSLACK, 1);
+
+    struct epoll_event event = { .events = EPOLLIN, .data = (u64)fds_len };
+    i32 error = epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->tick_fd, &event);
+    if (error != 0) {
+        return MAIN_ERROR_EPOLL;
+    }
+    for (i32 i = 0; i < fds_len; ++i) {
+        if (fds[i].fd < 0) {
+            continue;
+        }
+        event.events = (u32)fds[i].events;
+        event.data = (u64)i;
+        error = epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fds[i].fd, &event);
+        if (error != 0) {
+            return MAIN_ERROR_EPOLL;
+        }
+    }
+    return MAIN_ERROR_NONE;
+}
+
+static i32 event_loop_wait_uring(
+    struct event_loop *loop,
+    struct pollfd *fds,
+    i64 deadline_ns
+) {
+    struct uring *ring = &loop->ring;
+    for (i32 i = 0; i < loop->fds_len; ++i) {
+        struct event_loop_slot *slot = &loop->slots[i];
+        if (slot->kind == EVENT_LOOP_SLOT_NONE || slot->posted || slot->ready) {
+            continue;
+        }
+        i32 error;
+        if (slot->kind == EVENT_LOOP_SLOT_READ) {
+            error = uring_read(
+                ring,
+                fds[i].fd,
+                slot->bytes,
+                loop->read_size,
+                (u64)i
+            );
+        } else {
+            error = uring_poll(ring, fds[i].fd, (u32)fds[i].events, (u64)i);
+        }
+        if (error != 0) {
+            return MAIN_ERROR_EPOLL;
+        }
+        slot->posted = 1;
+    }
+
+    i64 timeout_ns = deadline_ns - EVENT_LOOP_SPIN_NS;
+    if (loop->timeout_ns != timeout_ns) {
+        loop->timeout_fired = 0;
+    }
+    if (
+        !loop->timeout_fired &&
+        (!loop->timeout_posted || loop->timeout_ns != timeout_ns)
+    ) {
+        u64 tag = (u64)EVENT_LOOP_TAG_TIMEOUT << EVENT_LOOP_TAG_SHIFT;
+        if (loop->timeout_posted) {
+            i32 error = uring_timeout_remove(
+                ring,
+                tag | loop->timeout_generation,
+                (u64)EVENT_LOOP_TAG_REMOVE << EVENT_LOOP_TAG_SHIFT
+            );
+            if (error != 0) {
+                return MAIN_ERROR_EPOLL;
+            }
+        }
+        loop->timeout_generation += 1;
+        loop->timeout_ns = timeout_ns;
+        loop->timeout.sec = timeout_ns / (1000L * 1000L * 1000L);
+        loop->timeout.nsec = timeout_ns % (1000L * 1000L * 1000L);
+        i32 error = uring_timeout(
+            ring,
+            &loop->timeout,
+            tag | loop->timeout_generation
+        );
+        if (error != 0) {
+            return MAIN_ERROR_EPOLL;
+        }
+        loop->timeout_posted = 1;
+    }
+
+    i32 error = uring_submit(ring, loop->timeout_fired ? 0 : 1);
+    if (error != 0) {
+        return MAIN_ERROR_EPOLL;
+    }
+
+    struct uring_completion completions[EVENT_LOOP_URING_ENTRIES];
+    i32 completions_len;
+    while (
+        (completions_len = uring_harvest(
+            ring,
+            completions,
+            EVENT_LOOP_URING_ENTRIES
+        )) > 0
+    ) {
+        for (i32 i = 0; i < completions_len; ++i) {
+            u64 user_data = completions[i].user_data;
+            u64 tag = user_data >> EVENT_LOOP_TAG_SHIFT;
+            if (tag == EVENT_LOOP_TAG_TIMEOUT) {
+                if ((u32)user_data == loop->timeout_generation) {
+                    loop->timeout_posted = 0;
+                    loop->timeout_fired = completions[i].res == -ETIME;
+                }
+                continue;
+            }
+            if (tag != EVENT_LOOP_TAG_FD) {
+                continue;
+            }
+            struct event_loop_slot *slot = &loop->slots[user_data];
+            slot->posted = 0;
+            slot->ready = 1;
+            slot->result = completions[i].res;
+        }
+    }
+
+    for (i32 i = 0; i < loop->fds_len; ++i) {
+        fds[i].revents = 0;
+        struct event_loop_slot *slot = &loop->slots[i];
+        if (slot->ready) {
+            fds[i].revents = POLLIN;
+            if (slot->kind == EVENT_LOOP_SLOT_POLL && slot->result > 0) {
+                fds[i].revents = (i16)slot->result;
+            }
+        }
+    }
+    return MAIN_ERROR_NONE;
+}
+
+static i32 event_loop_wait(
+    struct event_loop *loop,
+    struct pollfd *fds,
+    i64 deadline_ns
+) {
+    if (loop->mode == EVENT_LOOP_POLL) {
+        poll(fds, loop->fds_len, 0);
+        return MAIN_ERROR_NONE;
+    }
+    if (loop->mode == EVENT_LOOP_URING) {
+        return event_loop_wait_uring(loop, fds, deadline_ns);
+    }
+
+    struct timespec now;
+    i32 error = clock_gettime(CLOCK_MONOTONIC, &now);
+    if (error != 0) {
+        return MAIN_ERROR_CLOCK_GETTIME;
+    }
+    i64 now_ns = now.sec * 1000L * 1000L * 1000L + now.nsec;
+    i32 timeout_ms = 0;
+    if (deadline_ns - now_ns > EVENT_LOOP_SPIN_NS) {
+        deadline_ns -= EVENT_LOOP_SPIN_NS;
+        struct itimerspec timer = {
+            .value = {
+                .sec = deadline_ns / (1000L * 1000L * 1000L),
+                .nsec = deadline_ns % (1000L * 1000L * 1000L),
+            },
+        };
+        error = timerfd_settime(loop->tick_fd, TFD_TIMER_ABSTIME, &timer);
+        if (error != 0) {
+            return MAIN_ERROR_TIMERFD;
+        }
+        timeout_ms = -1;
+    }
+
+    struct epoll_event events[32 + 3];
+    i32 events_len = epoll_wait(
+        loop->epoll_fd,
+        events,
+        sizeof(events) / sizeof(*events),
+        timeout_ms
+    );
+    if (events_len < 0) {
+        return MAIN_ERROR_EPOLL;
+    }
+    for (i32 i = 0; i < loop->fds_len; ++i) {
+        fds[i].revents = 0;
+    }
+    for (i32 i = 0; i < events_len; ++i) {
+        i32 index = (i32)events[i].data;
+        if (index == loop->fds_len) {
+            u64 expirations;
+            read(loop->tick_fd, (char *)&expirations, sizeof(expirations));
+        } else {
+            fds[index].revents = (i16)events[i].events;
+        }
+    }
+    return MAIN_ERROR_NONE;
+}
+
+static i64 event_loop_read(
+    struct event_loop *loop,
+    struct pollfd *fds,
+    i32 index,
+    char *bytes,
+    i64 len
+) {
+    if (
+        loop->mode != EVENT_LOOP_URING ||
+        loop->slots[index].kind != EVENT_LOOP_SLOT_READ
+    ) {
+        if (loop->mode == EVENT_LOOP_URING) {
+            loop->slots[index].ready = 0;
+        }
+        return read(fds[index].fd, bytes, len);
+    }
+
+    struct event_loop_slot *slot = &loop->slots[index];
+    slot->ready = 0;
+    if (slot->result < 0) {
+        return slot->result;
+    }
+    i64 result = (slot->result < len) ? slot->result : len;
+    memcpy(bytes, slot->bytes, (u64)result);
+    return result;
+}
+
+enum mailbox_limits {
+    MAILBOX_MAX_BUFFERS = 8,
+    MAILBOX_LATCH_NS = 2 * 1000 * 1000,
+};
+
+struct mailbox {
+    i32 buffers_len;
+    i32 shown;
+    i32 pending;
+    i32 ready;
+    i64 ready_render_ns;
+    i64 latch_ns;
+};
+
+static i32 mailbox_free_buffer(struct mailbox *mailbox) {
+    for (i32 i = 0; i < mailbox->buffers_len; ++i) {
+        if (
+            i != mailbox->shown &&
+            i != mailbox->pending &&
+            i != mailbox->ready
+        ) {
+            return i;
+        }
+    }
+    return mailbox->ready;
+}
+
+static i32 mailbox_queue(
+    struct mailbox *mailbox,
+    struct display *display,
+    struct drm_mode_dumb_buffer **bufs,
+    struct board_damage *damage,
+    struct frame_stats *stats
+) {
+    if (mailbox->pending >= 0 || mailbox->ready < 0) {
+        return MAIN_ERROR_NONE;
+    }
+    display_dirty(
+        display,
+        bufs[mailbox->ready],
+        &damage[mailbox->ready],
+        stats
+    );
+    i32 error = display_flip(display, bufs[mailbox->ready]);
+    if (error != 0) {
+        return MAIN_ERROR_DRM_PAGE_FLIP;
+    }
+    frame_stats_draw(stats, mailbox->ready_render_ns);
+    mailbox->pending = mailbox->ready;
+    mailbox->ready = -1;
+    mailbox->latch_ns = 0;
+    return MAIN_ERROR_NONE;
+}
+
+static char *parse_u32(char *s, u32 *value) {
+    if (*s < '0' || *s > '9') {
+        return 0;
+    }
+    *value = 0;
+    while (*s >= '0' && *s <= '9') {
+        *value = *value * 10 + (u32)(*s - '0');
+        s += 1;
+    }
+    return s;
+}
+
+static char *parse_prefix(char *s, char *prefix) {
+    while (*prefix != 0) {
+        if (*s != *prefix) {
+            return 0;
+        }
+        s += 1;
+        prefix += 1;
+    }
+    return s;
+}
+
+static char *parse_size(char *s, u32 *width, u32 *height) {
+    s = parse_u32(s, width);
+    if (s == 0 || *s != 'x') {
+        return 0;
+    }
+    return parse_u32(s + 1, height);
+}
+
+static i32 parse_offscreen(char *s, u32 *width, u32 *height, u32 *hz) {
+    s = parse_size(s, width, height);
+    if (s == 0 || *s != '@') {
+        return -1;
+    }
+    s = parse_u32(s + 1, hz);
+    if (s == 0 || *s != 0) {
+        return -1;
+    }
+    if (*width == 0 || *height == 0 || *hz == 0) {
+        return -1;
+    }
+    return 0;
+}
 
-    struct arena arena = { .start = mem, .end = mem + arena_size };
-
-    i32 card_fd = open("/dev/dri/card0", O_RDWR, 0);
-    if (card_fd < 0) {
-        return MAIN_ERROR_OPEN_CARD0;
+static void board_fit(struct display *display, u32 *width, u32 *height) {
+    u32 square_len = display->width;
+    if (display->height < square_len) {
+        square_len = display->height;
+    }
+    u32 scale = square_len / 90;
+    if (scale == 0) {
+        scale = 1;
+    }
+    *width = display->width / scale;
+    *height = display->height / scale;
+    if (*width > BOARD_MAX_SIZE) {
+        *width = BOARD_MAX_SIZE;
     }
+    if (*height > BOARD_MAX_SIZE) {
+        *height = BOARD_MAX_SIZE;
+    }
+}
 
-    struct drm_mode_resources *res = drm_mode_get_resources(&arena, card_fd);
-    if (res == 0) {
-        return MAIN_ERROR_DRM_GET_RESOURCES;
+static u64 game_checksum(struct game_state *state) {
+    u64 hash = 0xcbf29ce484222325UL;
+    for (i32 i = 0; i < state->height * state->row_words; ++i) {
+        hash = (hash ^ state->board[i]) * 0x100000001b3UL;
     }
+    hash = (hash ^ (u64)(u32)state->x) * 0x100000001b3UL;
+    hash = (hash ^ (u64)(u32)state->y) * 0x100000001b3UL;
+    return hash;
+}
 
-    u32 conn_index;
-    struct drm_mode_connector *conn = 0;
-    for (conn_index = 0; conn_index < res->connectors_len; ++conn_index) {
-        conn = drm_mode_get_connector(
-            &arena,
-            card_fd,
-            res->connectors[conn_index]
+static i32 run_replay(
+    struct arena *arena,
+    char *path,
+    struct display *display,
+    enum render_mode render_mode
+) {
+    struct replay replay;
+    i32 error = replay_load(&replay, arena, path);
+    if (error != 0) {
+        return MAIN_ERROR_REPLAY;
+    }
+
+    struct game_state *game_state = alloc(arena, sizeof(*game_state));
+    if (game_state == 0) {
+        return MAIN_ERROR_ALLOC;
+    }
+    error = game_init(
+        game_state,
+        arena,
+        replay.header.width,
+        replay.header.height
+    );
+    if (error != 0) {
+        return MAIN_ERROR_BOARD;
+    }
+    clear_game(game_state);
+    if (
+        replay.header.x != game_state->x ||
+        replay.header.y != game_state->y ||
+        replay.header.vx != game_state->vx ||
+        replay.header.vy != game_state->vy ||
+        replay.header.timestep != game_state->timestep
+    ) {
+        return MAIN_ERROR_REPLAY;
+    }
+
+    struct drm_mode_dumb_buffer *bufs[2];
+    struct board_damage damage[2];
+    struct renderer renderer;
+    if (display != 0) {
+        bufs[0] = display_create_buffer(display, arena);
+        bufs[1] = display_create_buffer(display, arena);
+        if (bufs[0] == 0 || bufs[1] == 0) {
+            return MAIN_ERROR_DRM_CREATE_DUMB_BUFFER;
+        }
+        error = renderer_init(
+            &renderer,
+            arena,
+            render_mode,
+            display->format,
+            display->width,
+            display->height,
+            game_state
         );
-        if (conn == 0) {
-            continue;
+        if (error != 0) {
+            return MAIN_ERROR_RENDERER_INIT;
         }
-        if (conn->connection == DRM_MODE_CONNECTED && conn->modes_len != 0) {
-            break;
+        for (i32 i = 0; i < 2; ++i) {
+            error = board_damage_init(&damage[i], arena, game_state);
+            if (error != 0) {
+                return MAIN_ERROR_ALLOC;
+            }
         }
     }
-    if (conn_index == res->connectors_len || conn == 0) {
-        return MAIN_ERROR_DRM_FIND_CONNECTOR;
+
+    u64 deaths = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (u32 tick = 0; tick < replay.ticks; ++tick) {
+        i32 vx, vy;
+        if (replay_turn(&replay, tick, &vx, &vy)) {
+            game_state->nvx = vx;
+            game_state->nvy = vy;
+            game_state->nnvx = vx;
+            game_state->nnvy = vy;
+        }
+        update_game(game_state);
+        if (game_state->dead) {
+            clear_game(game_state);
+            deaths += 1;
+        }
+
+        if (display != 0) {
+            u32 buf_index = tick & 1;
+            draw_damage(
+                &renderer,
+                bufs[buf_index],
+                &damage[buf_index],
+                game_state
+            );
+            damage[buf_index].partial_cell = draw_partial(
+                &renderer,
+                bufs[buf_index],
+                game_state,
+                renderer.scale / 2
+            );
+        }
     }
+    clock_gettime(CLOCK_MONOTONIC, &end);
 
-    struct drm_mode_encoder *enc = drm_mode_get_encoder(
-        &arena,
-        card_fd,
-        conn->encoder_id
-    );
-    if (enc == 0) {
-        return MAIN_ERROR_DRM_GET_ENCODER;
+    i64 elapsed = time_since_ns(&end, &start);
+    if (elapsed <= 0) {
+        elapsed = 1;
     }
 
-    u32 buf_index = 0;
-    struct drm_mode_dumb_buffer *bufs[2];
-    bufs[0] = drm_mode_create_dumb_buffer(
-        &arena,
-        card_fd,
-        conn->modes[0].hdisplay,
-        conn->modes[0].vdisplay
-    );
-    bufs[1] = drm_mode_create_dumb_buffer(
-        &arena,
-        card_fd,
-        conn->modes[0].hdisplay,
-        conn->modes[0].vdisplay
+    struct print_buffer out;
+    out.fd = STDERR;
+    out.len = 0;
+    print_str(&out, "ticks=");
+    print_u64(&out, replay.ticks);
+    print_str(&out, " deaths=");
+    print_u64(&out, deaths);
+    print_str(&out, " elapsed_ns=");
+    print_u64(&out, (u64)elapsed);
+    print_str(&out, " ticks_per_sec=");
+    print_u64(
+        &out,
+        (u64)replay.ticks * 1000UL * 1000UL * 1000UL / (u64)elapsed
     );
-    if (bufs[0] == 0 || bufs[1] == 0) {
-        return MAIN_ERROR_DRM_CREATE_DUMB_BUFFER;
+    if (display != 0 && replay.ticks > 0) {
+        print_str(&out, " ns_per_frame=");
+        print_u64(&out, (u64)elapsed / replay.ticks);
     }
+    print_str(&out, " checksum=");
+    print_u64(&out, game_checksum(game_state));
+    print_str(&out, "\n");
+    print_flush(&out);
 
-    struct drm_mode_crtc *crtc = drm_mode_get_crtc(
-        &arena,
-        card_fd,
-        enc->crtc_id
-    );
-    if (crtc == 0) {
-        return MAIN_ERROR_DRM_GET_CRTC;
+    return MAIN_ERROR_NONE;
+}
+
+static i32 main_exit(
+    struct frame_stats *stats,
+    struct render_thread *render,
+    struct replay_writer *recording,
+    u32 ticks
+) {
+    if (render != 0) {
+        __atomic_store_n(&render->quit, 1, __ATOMIC_RELEASE);
+        thread_join(&render->thread);
+    }
+    frame_stats_print(stats);
+    if (recording != 0) {
+        i32 error = replay_writer_close(recording, ticks);
+        if (error != 0) {
+            return MAIN_ERROR_RECORD;
+        }
     }
+    return MAIN_ERROR_NONE;
+}
 
-    crtc->mode = conn->modes[0];
+i32 main(i32 argc, char **argv) {
+    struct display display;
+    display.format = PIXEL_FORMAT_XRGB8888;
+    enum render_mode render_mode = RENDER_MODE_SPAN;
+    i32 offscreen = 0;
+    u32 offscreen_width = 1920;
+    u32 offscreen_height = 1080;
+    u32 offscreen_hz = 60;
+    i32 fake_drm = 0;
+    u32 fake_width = 1920;
+    u32 fake_height = 1080;
+    u32 fake_hz = 60;
+    char *fake_keys = "";
+    i32 syscall_stats_enabled = 0;
+    i32 huge_pages = 0;
+    i64 frames_left = -1;
+    char *record_path = 0;
+    char *replay_path = 0;
+    i32 board_fit_display = 0;
+    u32 board_width = 90;
+    u32 board_height = 90;
+    i64 bot_budget_ns = 0;
+    i64 mcts_budget_ns = 0;
+    u32 mcts_threads = 0;
+    i32 render_threaded = 0;
+    i32 shadowed = 0;
+    u32 raster_threads = 1;
+    u32 buffers_len = 2;
+    enum event_loop_mode loop_mode = EVENT_LOOP_URING;
+    for (i32 i = 1; i < argc; ++i) {
+        char *value;
+        if (str_equal(argv[i], "--render=span")) {
+            render_mode = RENDER_MODE_SPAN;
+        } else if (str_equal(argv[i], "--render=stream")) {
+            render_mode = RENDER_MODE_STREAM;
+        } else if (str_equal(argv[i], "--render=expand")) {
+            render_mode = RENDER_MODE_EXPAND;
+        } else if (str_equal(argv[i], "--format=xrgb8888")) {
+            display.format = PIXEL_FORMAT_XRGB8888;
+        } else if (str_equal(argv[i], "--format=rgb565")) {
+            display.format = PIXEL_FORMAT_RGB565;
+        } else if (str_equal(argv[i], "--offscreen")) {
+            offscreen = 1;
+        } else if ((value = parse_prefix(argv[i], "--offscreen=")) != 0) {
+            offscreen = 1;
+            i32 error = parse_offscreen(
+                value,
+                &offscreen_width,
+                &offscreen_height,
+                &offscreen_hz
+            );
+            if (error != 0) {
+                return MAIN_ERROR_ARGS;
+            }
+        } else if (str_equal(argv[i], "--fake-drm")) {
+            fake_drm = 1;
+        } else if ((value = parse_prefix(argv[i], "--fake-drm=")) != 0) {
+            fake_drm = 1;
+            i32 error = parse_offscreen(
+                value,
+                &fake_width,
+                &fake_height,
+                &fake_hz
+            );
+            if (error != 0) {
+                return MAIN_ERROR_ARGS;
+            }
+        } else if ((value = parse_prefix(argv[i], "--fake-keys=")) != 0) {
+            fake_keys = value;
+        } else if (str_equal(argv[i], "--syscall-stats")) {
+            syscall_stats_enabled = 1;
+        } else if (str_equal(argv[i], "--huge-pages")) {
+            huge_pages = 1;
+        } else if (str_equal(argv[i], "--loop=uring")) {
+            loop_mode = EVENT_LOOP_URING;
+        } else if (str_equal(argv[i], "--loop=epoll")) {
+            loop_mode = EVENT_LOOP_EPOLL;
+        } else if (str_equal(argv[i], "--loop=poll")) {
+            loop_mode = EVENT_LOOP_POLL;
+        } else if (str_equal(argv[i], "--render-thread")) {
+            render_threaded = 1;
+        } else if (str_equal(argv[i], "--shadow")) {
+            shadowed = 1;
+        } else if ((value = parse_prefix(argv[i], "--raster-threads=")) != 0) {
+            value = parse_u32(value, &raster_threads);
+            if (value == 0 || *value != 0 || raster_threads == 0) {
+                return MAIN_ERROR_ARGS;
+            }
+        } else if ((value = parse_prefix(argv[i], "--buffers=")) != 0) {
+            value = parse_u32(value, &buffers_len);
+            if (
+                value == 0 ||
+                *value != 0 ||
+                buffers_len < 2 ||
+                buffers_len > MAILBOX_MAX_BUFFERS
+            ) {
+                return MAIN_ERROR_ARGS;
+            }
+        } else if ((value = parse_prefix(argv[i], "--frames=")) != 0) {
+            u32 frames;
+            value = parse_u32(value, &frames);
+            if (value == 0 || *value != 0 || frames == 0) {
+                return MAIN_ERROR_ARGS;
+            }
+            frames_left = frames;
+        } else if (str_equal(argv[i], "--board=fit")) {
+            board_fit_display = 1;
+        } else if ((value = parse_prefix(argv[i], "--board=")) != 0) {
+            board_fit_display = 0;
+            value = parse_size(value, &board_width, &board_height);
+            if (value == 0 || *value != 0) {
+                return MAIN_ERROR_ARGS;
+            }
+        } else if (str_equal(argv[i], "--bot")) {
+            bot_budget_ns = 2L * 1000L * 1000L;
+        } else if ((value = parse_prefix(argv[i], "--bot=")) != 0) {
+            u32 budget;
+            value = parse_u32(value, &budget);
+            if (value == 0 || *value != 0 || budget == 0) {
+                return MAIN_ERROR_ARGS;
+            }
+            bot_budget_ns = budget;
+        } else if (str_equal(argv[i], "--mcts")) {
+            mcts_budget_ns = 4L * 1000L * 1000L;
+        } else if ((value = parse_prefix(argv[i], "--mcts=")) != 0) {
+            u32 budget;
+            value = parse_u32(value, &budget);
+            if (value == 0 || *value != 0 || budget == 0) {
+                return MAIN_ERROR_ARGS;
+            }
+            mcts_budget_ns = budget;
+        } else if ((value = parse_prefix(argv[i], "--mcts-threads=")) != 0) {
+            value = parse_u32(value, &mcts_threads);
+            if (value == 0 || *value != 0 || mcts_threads == 0) {
+                return MAIN_ERROR_ARGS;
+            }
+        } else if ((value = parse_prefix(argv[i], "--record=")) != 0) {
+            record_path = value;
+        } else if ((value = parse_prefix(argv[i], "--replay=")) != 0) {
+            replay_path = value;
+        } else {
+            return MAIN_ERROR_ARGS;
+        }
+    }
+    if (render_threaded && buffers_len > 2) {
+        return MAIN_ERROR_ARGS;
+    }
+    if (fake_drm && offscreen) {
+        return MAIN_ERROR_ARGS;
+    }
+    if (fake_drm && loop_mode == EVENT_LOOP_URING) {
+        loop_mode = EVENT_LOOP_EPOLL;
+    }
 
-    i32 error = drm_mode_set_crtc(
-        card_fd,
-        crtc,
-        &conn->connector_id,
-        1,
-        bufs[buf_index]->fb_id
-    );
+    char *mem = arena_map(ARENA_SIZE, huge_pages);
+    if (mem == 0) {
+        return MAIN_ERROR_MMAP;
+    }
+
+    struct arena arena;
+    arena_init(&arena, mem, ARENA_SIZE);
+
+    struct syscall_stats *syscalls = 0;
+    if (syscall_stats_enabled) {
+        syscalls = alloc(&arena, sizeof(*syscalls));
+        if (syscalls == 0) {
+            return MAIN_ERROR_ALLOC;
+        }
+        syscall_stats_enable(syscalls);
+    }
+
+    i32 error;
+    if (fake_drm) {
+        struct fake_drm *fake = alloc(&arena, sizeof(*fake));
+        if (fake == 0) {
+            return MAIN_ERROR_ALLOC;
+        }
+        error = fake_drm_init(
+            fake,
+            fake_width,
+            fake_height,
+            fake_hz,
+            fake_keys,
+            FAKE_DRM_KEY_INTERVAL_NS
+        );
+        if (error != 0) {
+            return MAIN_ERROR_ARGS;
+        }
+        syscall_layer_set(&fake->layer);
+    }
+
+    if (replay_path != 0) {
+        if (!offscreen) {
+            return run_replay(&arena, replay_path, 0, render_mode);
+        }
+        error = display_open_offscreen(
+            &display,
+            offscreen_width,
+            offscreen_height,
+            offscreen_hz
+        );
+        if (error != MAIN_ERROR_NONE) {
+            return error;
+        }
+        return run_replay(&arena, replay_path, &display, render_mode);
+    }
+
+    if (offscreen) {
+        error = display_open_offscreen(
+            &display,
+            offscreen_width,
+            offscreen_height,
+            offscreen_hz
+        );
+    } else {
+        error = display_open_drm(&display, &arena);
+    }
+    if (error != MAIN_ERROR_NONE) {
+        return error;
+    }
+
+    u32 buf_index = 0;
+    struct drm_mode_dumb_buffer *bufs[MAILBOX_MAX_BUFFERS];
+    for (u32 i = 0; i < buffers_len; ++i) {
+        bufs[i] = display_create_buffer(&display, &arena);
+        if (bufs[i] == 0) {
+            return MAIN_ERROR_DRM_CREATE_DUMB_BUFFER;
+        }
+    }
+
+    error = display_set_buffer(&display, bufs[buf_index]);
     if (error != 0) {
         return MAIN_ERROR_DRM_SET_CRTC;
     }
     buf_index ^= 1;
 
-    error = drm_mode_set_crtc(
-        card_fd,
-        crtc,
-        &conn->connector_id,
-        1,
-        bufs[buf_index]->fb_id
-    );
+    error = display_set_buffer(&display, bufs[buf_index]);
     if (error != 0) {
         return MAIN_ERROR_DRM_SET_CRTC;
     }
     buf_index ^= 1;
 
-    error = drm_mode_crtc_page_flip(
-        card_fd,
-        crtc->crtc_id,
-        bufs[buf_index]->fb_id
-    );
+    error = display_flip(&display, bufs[buf_index]);
     if (error != 0) {
         return MAIN_ERROR_DRM_PAGE_FLIP;
     }
     buf_index ^= 1;
 
+    struct mailbox mailbox = {
+        .buffers_len = (i32)buffers_len,
+        .shown = 1,
+        .pending = 0,
+        .ready = -1,
+        .ready_render_ns = 0,
+        .latch_ns = 0,
+    };
+
     i64 elapsed = 0;
     struct timespec last, now;
     error = clock_gettime(CLOCK_MONOTONIC, &last);
-    if (error) {
+    if (error != 0) {
         return MAIN_ERROR_CLOCK_GETTIME;
     }
 
     i32 keyboards[32];
-    i32 keyboards_len = open_keyboards(
-        arena,
-        keyboards,
-        sizeof(keyboards) / sizeof(*keyboards)
-    );
-    if (keyboards_len <= 0) {
-        return MAIN_ERROR_OPEN_KEYBOARD;
+    i32 keyboards_len = 0;
+    if (display.backend == DISPLAY_BACKEND_DRM) {
+        keyboards_len = open_keyboards(
+            &arena,
+            keyboards,
+            sizeof(keyboards) / sizeof(*keyboards)
+        );
+        if (keyboards_len <= 0) {
+            return MAIN_ERROR_OPEN_KEYBOARD;
+        }
+    }
+
+    u64 signal_mask = (1UL << (SIGINT - 1)) |
+        (1UL << (SIGUSR1 - 1)) |
+        (1UL << (SIGTERM - 1));
+    error = rt_sigprocmask(SIG_BLOCK, &signal_mask, 0);
+    if (error != 0) {
+        return MAIN_ERROR_SIGNALFD;
+    }
+    i32 signal_fd = signalfd(-1, &signal_mask, 0);
+    if (signal_fd < 0) {
+        return MAIN_ERROR_SIGNALFD;
     }
 
-    struct input_event keyboard_events[32];
-    struct pollfd pollfds[32 + 1];
+    struct turn_queue turns;
+    turn_queue_clear(&turns);
+    struct pollfd pollfds[32 + 2];
     for (i32 i = 0; i < keyboards_len; ++i) {
         pollfds[i].fd = keyboards[i];
         pollfds[i].events = POLLIN;
     }
-    pollfds[keyboards_len].fd = card_fd;
+    pollfds[keyboards_len].fd = display.fd;
     pollfds[keyboards_len].events = POLLIN;
+    pollfds[keyboards_len + 1].fd = signal_fd;
+    pollfds[keyboards_len + 1].events = POLLIN;
 
-    u32 width = bufs[0]->width;
-    u32 height = bufs[0]->height;
-    u32 square_len = (height > width) ? width : height;
-    u32 scale = square_len / 90;
-    u32 board_size = square_len - (square_len % 90);
-    u32 board_x = (width / 2) - (board_size / 2);
-    u32 board_y = (height / 2) - (board_size / 2);
+    struct frame_stats *stats = alloc(&arena, sizeof(*stats));
+    if (stats == 0) {
+        return MAIN_ERROR_ALLOC;
+    }
+    stats->syscalls = syscalls;
+    stats->arena = &arena;
 
+    if (board_fit_display) {
+        board_fit(&display, &board_width, &board_height);
+    }
     struct game_state game_state;
+    error = game_init(
+        &game_state,
+        &arena,
+        (i32)board_width,
+        (i32)board_height
+    );
+    if (error != 0) {
+        return MAIN_ERROR_BOARD;
+    }
     clear_game(&game_state);
 
+    struct bot *bot = 0;
+    if (bot_budget_ns > 0) {
+        bot = alloc(&arena, sizeof(*bot));
+        if (bot == 0) {
+            return MAIN_ERROR_ALLOC;
+        }
+        error = bot_init(
+            bot,
+            &arena,
+            game_state.width,
+            game_state.height,
+            bot_budget_ns,
+            BOT_MAX_DEPTH
+        );
+        if (error != 0) {
+            return MAIN_ERROR_ALLOC;
+        }
+    }
+
+    struct mcts *mcts = 0;
+    if (mcts_budget_ns > 0) {
+        if (mcts_threads == 0) {
+            mcts_threads = (u32)cpu_count();
+        }
+        mcts = alloc(&arena, sizeof(*mcts));
+        if (mcts == 0) {
+            return MAIN_ERROR_ALLOC;
+        }
+        error = mcts_init(
+            mcts,
+            &arena,
+            game_state.width,
+            game_state.height,
+            mcts_budget_ns,
+            (i32)mcts_threads,
+            1024L * 1024L
+        );
+        if (error != 0) {
+            return MAIN_ERROR_MCTS;
+        }
+    }
+
+    struct renderer renderer;
+    error = renderer_init(
+        &renderer,
+        &arena,
+        render_mode,
+        display.format,
+        display.width,
+        display.height,
+        &game_state
+    );
+    if (error != 0) {
+        return MAIN_ERROR_RENDERER_INIT;
+    }
+    if (raster_threads > 1) {
+        struct band_pool *bands = alloc(&arena, sizeof(*bands));
+        if (bands == 0) {
+            return MAIN_ERROR_ALLOC;
+        }
+        error = band_pool_init(
+            bands,
+            &arena,
+            &renderer,
+            (i32)raster_threads
+        );
+        if (error != 0) {
+            return MAIN_ERROR_THREAD;
+        }
+        renderer.bands = bands;
+    }
+
+    u32 tick = 0;
+    struct replay_writer *recording = 0;
+    if (record_path != 0) {
+        recording = alloc(&arena, sizeof(*recording));
+        if (recording == 0) {
+            return MAIN_ERROR_ALLOC;
+        }
+        struct replay_header header = {
+            .width = game_state.width,
+            .height = game_state.height,
+            .x = game_state.x,
+            .y = game_state.y,
+            .vx = game_state.vx,
+            .vy = game_state.vy,
+            .timestep = game_state.timestep,
+        };
+        error = replay_writer_open(recording, record_path, &header);
+        if (error != 0) {
+            return MAIN_ERROR_RECORD;
+        }
+    }
+
+    struct board_damage damage[MAILBOX_MAX_BUFFERS];
+    for (u32 i = 0; i < buffers_len; ++i) {
+        error = board_damage_init(&damage[i], &arena, &game_state);
+        if (error != 0) {
+            return MAIN_ERROR_ALLOC;
+        }
+    }
+
+    struct shadow_buffer *shadow = 0;
+    if (shadowed) {
+        shadow = alloc(&arena, sizeof(*shadow));
+        if (shadow == 0) {
+            return MAIN_ERROR_ALLOC;
+        }
+        shadow->buf = memory_buffer_create(
+            &arena,
+            display.width,
+            display.height,
+            display_bpp(&display)
+        );
+        if (shadow->buf == 0) {
+            return MAIN_ERROR_MMAP;
+        }
+        error = board_damage_init(&shadow->damage, &arena, &game_state);
+        if (error != 0) {
+            return MAIN_ERROR_ALLOC;
+        }
+        shadow->targets = damage;
+        shadow->targets_len = (i32)buffers_len;
+    }
+
+    struct render_thread *render = 0;
+    i32 publish = 0;
+    i32 redraw = 0;
+    if (render_threaded) {
+        render = alloc(&arena, sizeof(*render));
+        if (render == 0) {
+            return MAIN_ERROR_ALLOC;
+        }
+        error = render_thread_init(render, &arena, &game_state);
+        char *stack = alloc(&arena, RENDER_STACK_SIZE);
+        if (error != 0 || stack == 0) {
+            return MAIN_ERROR_ALLOC;
+        }
+        render->display = &display;
+        render->renderer = &renderer;
+        render->bufs = bufs;
+        render->damage = damage;
+        render->shadow = shadow;
+        render->shared_stats = stats;
+        render->buf_index = buf_index;
+        render->frames_left = frames_left;
+        render_publish(
+            render,
+            &game_state,
+            last.sec * 1000L * 1000L * 1000L + last.nsec,
+            stats
+        );
+
+        error = thread_create(
+            &render->thread,
+            stack,
+            RENDER_STACK_SIZE,
+            render_thread_main,
+            render
+        );
+        if (error != 0) {
+            return MAIN_ERROR_THREAD;
+        }
+        pollfds[keyboards_len].fd = -1;
+    }
+
+    struct arena scratch;
+    if (arena_split(&arena, &scratch, FRAME_SCRATCH_SIZE) != 0) {
+        return MAIN_ERROR_ALLOC;
+    }
+    stats->scratch = &scratch;
+
+    struct event_loop loop;
+    error = event_loop_init(
+        &loop,
+        &arena,
+        loop_mode,
+        pollfds,
+        keyboards_len + 2,
+        keyboards_len + 1,
+        KEYBOARD_EVENTS_LEN * (i64)sizeof(struct input_event)
+    );
+    if (error != MAIN_ERROR_NONE) {
+        return error;
+    }
+
     while (1) {
+        arena_reset(&scratch);
+        if (
+            render != 0 &&
+            __atomic_load_n(&render->stopped, __ATOMIC_ACQUIRE)
+        ) {
+            thread_join(&render->thread);
+            if (render->error != MAIN_ERROR_NONE) {
+                return render->error;
+            }
+            return main_exit(stats, 0, recording, tick);
+        }
+        if (render != 0) {
+            u32 acks = __atomic_load_n(&render->print_acks, __ATOMIC_ACQUIRE);
+            if (acks != render->printed) {
+                render->printed = acks;
+                frame_stats_print(stats);
+            }
+        }
+
+        i64 deadline_ns = last.sec * 1000L * 1000L * 1000L + last.nsec +
+            game_state.timestep - elapsed;
+        if (mailbox.latch_ns != 0 && mailbox.latch_ns < deadline_ns) {
+            deadline_ns = mailbox.latch_ns;
+        }
+        error = event_loop_wait(&loop, pollfds, deadline_ns);
+        if (error != MAIN_ERROR_NONE) {
+            return error;
+        }
+
         error = clock_gettime(CLOCK_MONOTONIC, &now);
         if (error != 0) {
             return MAIN_ERROR_CLOCK_GETTIME;
         }
         elapsed += time_since_ns(&now, &last);
         last = now;
+        i64 now_ns = now.sec * 1000L * 1000L * 1000L + now.nsec;
+        struct input_event *keyboard_events = alloc_uninit(
+            &scratch,
+            KEYBOARD_EVENTS_LEN * (i64)sizeof(*keyboard_events)
+        );
+        char *display_events = alloc_uninit(&scratch, DISPLAY_EVENTS_SIZE);
+        if (keyboard_events == 0 || display_events == 0) {
+            return MAIN_ERROR_ALLOC;
+        }
+        if (mailbox.latch_ns != 0 && now_ns >= mailbox.latch_ns) {
+            mailbox.latch_ns = 0;
+            redraw = 1;
+        }
 
-        poll(pollfds, keyboards_len + 1, 0);
         for (i32 i = 0; i < keyboards_len; ++i) {
             if (pollfds[i].revents == 0) {
                 continue;
             }
 
-            i32 keyboard_fd = pollfds[i].fd;
-
-            i64 len = read(
-                keyboard_fd,
+            i64 len = event_loop_read(
+                &loop,
+                pollfds,
+                i,
                 (char *)keyboard_events,
-                sizeof(keyboard_events)
+                KEYBOARD_EVENTS_LEN * (i64)sizeof(*keyboard_events)
             );
             if (len < 0) {
                 return MAIN_ERROR_READ_KEYBOARD;
@@ -1240,120 +2837,208 @@ i32 main(i32 argc, char **argv) {
                     continue;
                 }
 
+                i64 press_ns =
+                    keyboard_event->time.sec * 1000L * 1000L * 1000L +
+                    keyboard_event->time.usec * 1000L;
+                if (press_ns > now_ns) {
+                    press_ns = now_ns;
+                }
                 switch (keyboard_event->code) {
                     case KEY_ESC:
-                        return MAIN_ERROR_NONE;
+                        return main_exit(stats, render, recording, tick);
                     case KEY_A:
-                        if (
-                            game_state.nvx == game_state.vx &&
-                            game_state.nvy == game_state.vy
-                        ) {
-                            if (game_state.vx <= 0) {
-                                game_state.nvx = -1;
-                                game_state.nvy = 0;
-                                game_state.nnvx = -1;
-                                game_state.nnvy = 0;
-                            }
-                        } else {
-                            if (game_state.nvx <= 0) {
-                                game_state.nnvx = -1;
-                                game_state.nnvy = 0;
-                            }
-                        }
+                        turn_queue_push(&turns, press_ns, -1, 0);
                         break;
                     case KEY_D:
-                        if (
-                            game_state.nvx == game_state.vx &&
-                            game_state.nvy == game_state.vy
-                        ) {
-                            if (game_state.vx >= 0) {
-                                game_state.nvx = 1;
-                                game_state.nvy = 0;
-                                game_state.nnvx = 1;
-                                game_state.nnvy = 0;
-                            }
-                        } else {
-                            if (game_state.nvx >= 0) {
-                                game_state.nnvx = 1;
-                                game_state.nnvy = 0;
-                            }
-                        }
+                        turn_queue_push(&turns, press_ns, 1, 0);
                         break;
                     case KEY_W:
-                        if (
-                            game_state.nvx == game_state.vx &&
-                            game_state.nvy == game_state.vy
-                        ) {
-                            if (game_state.vy <= 0) {
-                                game_state.nvx = 0;
-                                game_state.nvy = -1;
-                                game_state.nnvx = 0;
-                                game_state.nnvy = -1;
-                            }
-                        } else {
-                            if (game_state.nvy <= 0) {
-                                game_state.nnvx = 0;
-                                game_state.nnvy = -1;
-                            }
-                        }
+                        turn_queue_push(&turns, press_ns, 0, -1);
                         break;
                     case KEY_S:
-                        if (
-                            game_state.nvx == game_state.vx &&
-                            game_state.nvy == game_state.vy
-                        ) {
-                            if (game_state.vy >= 0) {
-                                game_state.nvx = 0;
-                                game_state.nvy = 1;
-                                game_state.nnvx = 0;
-                                game_state.nnvy = 1;
-                            }
-                        } else {
-                            if (game_state.nvy >= 0) {
-                                game_state.nnvx = 0;
-                                game_state.nnvy = 1;
-                            }
-                        }
+                        turn_queue_push(&turns, press_ns, 0, 1);
                         break;
                     default:
-                        continue;
+                        break;
+                }
+            }
+        }
+
+        if (pollfds[keyboards_len + 1].revents != 0) {
+            struct signalfd_siginfo siginfo;
+            i64 len = event_loop_read(
+                &loop,
+                pollfds,
+                keyboards_len + 1,
+                (char *)&siginfo,
+                sizeof(siginfo)
+            );
+            if (len == sizeof(siginfo)) {
+                if (siginfo.signo != SIGUSR1) {
+                    return main_exit(stats, render, recording, tick);
+                }
+                if (render != 0) {
+                    __atomic_add_fetch(
+                        &render->print_requests,
+                        1,
+                        __ATOMIC_RELEASE
+                    );
+                } else {
+                    frame_stats_print(stats);
                 }
             }
         }
 
         while (elapsed >= game_state.timestep) {
+            histogram_record(
+                &stats->tick_lag,
+                (u64)(elapsed - game_state.timestep)
+            );
             elapsed -= game_state.timestep;
+            i64 press_ns = turn_queue_apply(
+                &turns,
+                &game_state,
+                now_ns - elapsed
+            );
+            i32 vx = game_state.vx;
+            i32 vy = game_state.vy;
             update_game(&game_state);
+            frame_stats_update(stats, &game_state, vx, vy, press_ns);
+            if (
+                recording != 0 &&
+                (game_state.vx != vx || game_state.vy != vy)
+            ) {
+                error = replay_writer_turn(
+                    recording,
+                    tick,
+                    game_state.vx,
+                    game_state.vy
+                );
+                if (error != 0) {
+                    return MAIN_ERROR_RECORD;
+                }
+            }
+            tick += 1;
 
             if (game_state.dead) {
                 clear_game(&game_state);
+                turn_queue_clear(&turns);
+                frame_stats_clear(stats);
+            }
+            frame_stats_tick(stats, now_ns - elapsed);
+            publish = 1;
+            redraw = 1;
+            if (bot != 0) {
+                bot_steer(bot, &game_state, stats);
+            } else if (mcts != 0) {
+                mcts_steer(mcts, &game_state, stats);
+            }
+        }
+
+        if (publish && render != 0) {
+            if (render_publish(render, &game_state, now_ns - elapsed, stats)) {
+                publish = 0;
             }
         }
 
         if (pollfds[keyboards_len].revents != 0) {
-            i32 result = drm_mode_handle_events(card_fd, arena);
-            if (result < 0) {
+            struct display_flip flip;
+            i64 len = event_loop_read(
+                &loop,
+                pollfds,
+                keyboards_len,
+                display_events,
+                DISPLAY_EVENTS_SIZE
+            );
+            if (len < 0) {
                 return MAIN_ERROR_DRM_HANDLE_EVENTS;
             }
+            i32 result = display_parse_events(
+                &display,
+                display_events,
+                len,
+                &flip
+            );
             if (result > 0) {
-                draw_game(bufs[buf_index], &game_state, board_x, board_y, scale);
-                draw_partial(
-                    bufs[buf_index],
-                    &game_state,
-                    board_x,
-                    board_y,
-                    scale,
-                    (u32)((elapsed * (i64)scale) / game_state.timestep)
-                );
-                error = drm_mode_crtc_page_flip(
-                    card_fd,
-                    crtc->crtc_id,
-                    bufs[buf_index]->fb_id
-                );
-                if (error != 0) {
-                    return MAIN_ERROR_DRM_PAGE_FLIP;
+                frame_stats_flip(stats, &flip);
+
+                if (mailbox.buffers_len > 2) {
+                    mailbox.shown = mailbox.pending;
+                    mailbox.pending = -1;
+                    error = mailbox_queue(
+                        &mailbox,
+                        &display,
+                        bufs,
+                        damage,
+                        stats
+                    );
+                    if (error != MAIN_ERROR_NONE) {
+                        return error;
+                    }
+                    if (mailbox.pending < 0) {
+                        mailbox.latch_ns = flip.time_ns;
+                        if (display.refresh_ns > 2 * MAILBOX_LATCH_NS) {
+                            mailbox.latch_ns +=
+                                display.refresh_ns - MAILBOX_LATCH_NS;
+                        }
+                    }
+                } else {
+                    i64 render_ns = draw_frame(
+                        &renderer,
+                        shadow,
+                        bufs[buf_index],
+                        &damage[buf_index],
+                        &game_state,
+                        (u32)(
+                            (elapsed * (i64)renderer.scale) /
+                            game_state.timestep
+                        )
+                    );
+                    frame_stats_draw(stats, render_ns);
+
+                    display_dirty(
+                        &display,
+                        bufs[buf_index],
+                        &damage[buf_index],
+                        stats
+                    );
+                    error = display_flip(&display, bufs[buf_index]);
+                    if (error != 0) {
+                        return MAIN_ERROR_DRM_PAGE_FLIP;
+                    }
+                    buf_index ^= 1;
+                }
+
+                if (frames_left > 0) {
+                    frames_left -= 1;
+                    if (frames_left == 0) {
+                        return main_exit(stats, render, recording, tick);
+                    }
                 }
-                buf_index ^= 1;
+            }
+        }
+
+        if (redraw && mailbox.buffers_len > 2) {
+            redraw = 0;
+            i32 index = mailbox_free_buffer(&mailbox);
+            mailbox.ready_render_ns = draw_frame(
+                &renderer,
+                shadow,
+                bufs[index],
+                &damage[index],
+                &game_state,
+                (u32)((elapsed * (i64)renderer.scale) / game_state.timestep)
+            );
+            mailbox.ready = index;
+            error = mailbox_queue(
+                &mailbox,
+                &display,
+                bufs,
+                damage,
+                stats
+            );
+            if (error != MAIN_ERROR_NONE) {
+                return error;
             }
         }
     }
@@ -1364,4 +3049,3 @@ i32 main(i32 argc, char **argv) {
 void _cstart(i32 argc, char **argv) {
     exit(main(argc, argv));
 }
-
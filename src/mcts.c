@@ -0,0 +1,470 @@
+#include "dumb_cycle.h"
+
+enum mcts_limits {
+    MCTS_MAX_WORKERS = 64,
+    MCTS_MAX_PATH = 256,
+    MCTS_JOBS_PER_WORKER = 4,
+    MCTS_ROLLOUT_LIMIT = 512,
+    MCTS_STACK_SIZE = 64 * 1024,
+};
+
+struct mcts_node {
+    struct mcts_node *children[3];
+    i32 children_len;
+    i32 expanded;
+    i32 x;
+    i32 y;
+    i32 vx;
+    i32 vy;
+    u32 visits;
+    u32 pending;
+    u64 reward;
+};
+
+struct mcts_job {
+    struct mcts_node **path;
+    i32 path_len;
+    u64 reward;
+};
+
+struct mcts_worker {
+    struct mcts *mcts;
+    i32 id;
+    u64 rng;
+    u64 *board;
+    struct thread thread;
+};
+
+static i64 mcts_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.sec * 1000L * 1000L * 1000L + now.nsec;
+}
+
+static u32 mcts_random(struct mcts_worker *worker) {
+    worker->rng ^= worker->rng << 13;
+    worker->rng ^= worker->rng >> 7;
+    worker->rng ^= worker->rng << 17;
+    return (u32)(worker->rng >> 32);
+}
+
+static i32 cell_free(struct mcts *mcts, u64 *board, i32 x, i32 y) {
+    if (x < 0 || x >= mcts->width || y < 0 || y >= mcts->height) {
+        return 0;
+    }
+    u64 word = board[y * mcts->row_words + x / 64];
+    return ((word >> (x % 64)) & 1) == 0;
+}
+
+static void cell_set(struct mcts *mcts, u64 *board, i32 x, i32 y) {
+    board[y * mcts->row_words + x / 64] |= 1UL << (x % 64);
+}
+
+static void board_copy(struct mcts *mcts, u64 *dst, u64 *src) {
+    memcpy(dst, src, (u64)(mcts->height * mcts->row_words) * sizeof(u64));
+}
+
+static void mcts_rollout(struct mcts_worker *worker, struct mcts_job *job) {
+    struct mcts *mcts = worker->mcts;
+    u64 *board = worker->board;
+    board_copy(mcts, board, mcts->board);
+    for (i32 i = 0; i < job->path_len; ++i) {
+        cell_set(mcts, board, job->path[i]->x, job->path[i]->y);
+    }
+
+    struct mcts_node *leaf = job->path[job->path_len - 1];
+    i32 x = leaf->x;
+    i32 y = leaf->y;
+    i32 vx = leaf->vx;
+    i32 vy = leaf->vy;
+    i32 steps = 0;
+    while (steps < MCTS_ROLLOUT_LIMIT) {
+        i32 options[3][2] = { { vx, vy }, { vy, -vx }, { -vy, vx } };
+        i32 first = (i32)(mcts_random(worker) % 3);
+        i32 moved = 0;
+        for (i32 i = 0; i < 3; ++i) {
+            i32 *option = options[(first + i) % 3];
+            if (cell_free(mcts, board, x + option[0], y + option[1])) {
+                vx = option[0];
+                vy = option[1];
+                x += vx;
+                y += vy;
+                cell_set(mcts, board, x, y);
+                moved = 1;
+                break;
+            }
+        }
+        if (!moved) {
+            break;
+        }
+        steps += 1;
+    }
+    job->reward = (u64)steps;
+}
+
+static void mcts_work(struct mcts *mcts, struct mcts_worker *worker) {
+    for (i32 i = worker->id; i < mcts->jobs_len; i += mcts->workers_len) {
+        mcts_rollout(worker, &mcts->jobs[i]);
+    }
+    u32 done = __atomic_add_fetch(&mcts->done, 1, __ATOMIC_ACQ_REL);
+    if (done == (u32)mcts->workers_len) {
+        futex_wake(&mcts->done, 1);
+    }
+}
+
+static void mcts_worker_main(void *arg) {
+    struct mcts_worker *worker = arg;
+    struct mcts *mcts = worker->mcts;
+    u32 seen = 0;
+    while (1) {
+        u32 generation = __atomic_load_n(&mcts->generation, __ATOMIC_ACQUIRE);
+        while (generation == seen) {
+            futex_wait(&mcts->generation, generation);
+            generation = __atomic_load_n(&mcts->generation, __ATOMIC_ACQUIRE);
+        }
+        seen = generation;
+        if (__atomic_load_n(&mcts->quit, __ATOMIC_ACQUIRE)) {
+            return;
+        }
+        mcts_work(mcts, worker);
+    }
+}
+
+static void mcts_run_jobs(struct mcts *mcts) {
+    __atomic_store_n(&mcts->done, 0, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&mcts->generation, 1, __ATOMIC_RELEASE);
+    if (mcts->workers_len > 1) {
+        futex_wake(&mcts->generation, mcts->workers_len - 1);
+    }
+    mcts_work(mcts, &mcts->workers[0]);
+    u32 done = __atomic_load_n(&mcts->done, __ATOMIC_ACQUIRE);
+    while (done != (u32)mcts->workers_len) {
+        futex_wait(&mcts->done, done);
+        done = __atomic_load_n(&mcts->done, __ATOMIC_ACQUIRE);
+    }
+}
+
+i32 mcts_init(
+    struct mcts *mcts,
+    struct arena *arena,
+    i32 width,
+    i32 height,
+    i64 budget_ns,
+    i32 workers_len,
+    i64 pool_size
+) {
+    if (workers_len < 1) {
+        workers_len = 1;
+    }
+    if (workers_len > MCTS_MAX_WORKERS) {
+        workers_len = MCTS_MAX_WORKERS;
+    }
+
+    mcts->budget_ns = budget_ns;
+    mcts->width = width;
+    mcts->height = height;
+    mcts->row_words = (width + 63) / 64;
+    mcts->pool = 0;
+    mcts->root = 0;
+    mcts->workers_len = workers_len;
+    mcts->generation = 0;
+    mcts->done = 0;
+    mcts->quit = 0;
+    mcts->rollouts = 0;
+
+    i64 board_size = height * mcts->row_words * (i64)sizeof(u64);
+    i32 jobs_capacity = workers_len * MCTS_JOBS_PER_WORKER;
+    mcts->board = alloc(arena, board_size);
+    mcts->select_board = alloc(arena, board_size);
+    mcts->workers = alloc(arena, workers_len * (i64)sizeof(*mcts->workers));
+    mcts->jobs = alloc(arena, jobs_capacity * (i64)sizeof(*mcts->jobs));
+    if (
+        mcts->board == 0 ||
+        mcts->select_board == 0 ||
+        mcts->workers == 0 ||
+        mcts->jobs == 0
+    ) {
+        return -1;
+    }
+    for (i32 i = 0; i < 2; ++i) {
+        if (arena_split(arena, &mcts->pools[i], pool_size) != 0) {
+            return -1;
+        }
+    }
+    for (i32 i = 0; i < jobs_capacity; ++i) {
+        mcts->jobs[i].path = alloc(
+            arena,
+            MCTS_MAX_PATH * (i64)sizeof(*mcts->jobs[i].path)
+        );
+        if (mcts->jobs[i].path == 0) {
+            return -1;
+        }
+    }
+
+    for (i32 i = 0; i < workers_len; ++i) {
+        struct mcts_worker *worker = &mcts->workers[i];
+        worker->mcts = mcts;
+        worker->id = i;
+        worker->rng = 0x9e3779b97f4a7c15UL * (u64)(i + 1);
+        worker->board = alloc(arena, board_size);
+        if (worker->board == 0) {
+            return -1;
+        }
+        if (i == 0) {
+            continue;
+        }
+        char *stack = alloc(arena, MCTS_STACK_SIZE);
+        if (stack == 0) {
+            return -1;
+        }
+        i32 error = thread_create(
+            &worker->thread,
+            stack,
+            MCTS_STACK_SIZE,
+            mcts_worker_main,
+            worker
+        );
+        if (error != 0) {
+            mcts->workers_len = i;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void mcts_stop(struct mcts *mcts) {
+    __atomic_store_n(&mcts->quit, 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&mcts->generation, 1, __ATOMIC_RELEASE);
+    futex_wake(&mcts->generation, mcts->workers_len);
+    for (i32 i = 1; i < mcts->workers_len; ++i) {
+        thread_join(&mcts->workers[i].thread);
+    }
+    mcts->workers_len = 1;
+}
+
+static struct mcts_node *mcts_node_new(
+    struct arena *pool,
+    i32 x,
+    i32 y,
+    i32 vx,
+    i32 vy
+) {
+    struct mcts_node *node = alloc_uninit(pool, sizeof(*node));
+    if (node == 0) {
+        return 0;
+    }
+    node->children_len = 0;
+    node->expanded = 0;
+    node->x = x;
+    node->y = y;
+    node->vx = vx;
+    node->vy = vy;
+    node->visits = 0;
+    node->pending = 0;
+    node->reward = 0;
+    return node;
+}
+
+static struct mcts_node *mcts_copy(
+    struct arena *pool,
+    struct mcts_node *node
+) {
+    struct mcts_node *copy = alloc_uninit(pool, sizeof(*copy));
+    if (copy == 0) {
+        return 0;
+    }
+    *copy = *node;
+    for (i32 i = 0; i < node->children_len; ++i) {
+        copy->children[i] = mcts_copy(pool, node->children[i]);
+        if (copy->children[i] == 0) {
+            copy->children_len = 0;
+            copy->expanded = 0;
+            break;
+        }
+    }
+    return copy;
+}
+
+static void mcts_expand(struct mcts *mcts, struct mcts_node *node) {
+    struct arena *pool = &mcts->pools[mcts->pool];
+    struct arena_checkpoint checkpoint = arena_save(pool);
+    i32 vx = node->vx;
+    i32 vy = node->vy;
+    i32 options[3][2] = { { vx, vy }, { vy, -vx }, { -vy, vx } };
+    i32 children_len = 0;
+    for (i32 i = 0; i < 3; ++i) {
+        i32 x = node->x + options[i][0];
+        i32 y = node->y + options[i][1];
+        if (!cell_free(mcts, mcts->select_board, x, y)) {
+            continue;
+        }
+        struct mcts_node *child = mcts_node_new(
+            pool,
+            x,
+            y,
+            options[i][0],
+            options[i][1]
+        );
+        if (child == 0) {
+            arena_restore(pool, checkpoint);
+            return;
+        }
+        node->children[children_len] = child;
+        children_len += 1;
+    }
+    node->children_len = children_len;
+    node->expanded = 1;
+}
+
+static double mcts_ln(u64 value) {
+    i32 exponent = 63 - __builtin_clzl(value);
+    double fraction = (double)(i64)(value - (1UL << exponent)) /
+        (double)(i64)(1UL << exponent);
+    return ((double)exponent + fraction) * 0.6931471805599453;
+}
+
+static double mcts_sqrt(double value) {
+    if (value <= 0.0) {
+        return 0.0;
+    }
+    double root = (value > 1.0) ? value : 1.0;
+    for (i32 i = 0; i < 24; ++i) {
+        root = 0.5 * (root + value / root);
+    }
+    return root;
+}
+
+static struct mcts_node *mcts_best_child(struct mcts_node *node) {
+    u64 parent_visits = (u64)node->visits + node->pending;
+    double log_visits = mcts_ln(parent_visits > 0 ? parent_visits : 1);
+    struct mcts_node *best = 0;
+    double best_score = 0.0;
+    for (i32 i = 0; i < node->children_len; ++i) {
+        struct mcts_node *child = node->children[i];
+        u64 visits = (u64)child->visits + child->pending;
+        if (visits == 0) {
+            return child;
+        }
+        double mean = (double)(i64)child->reward /
+            ((double)(i64)visits * MCTS_ROLLOUT_LIMIT);
+        double score = mean + 1.4 * mcts_sqrt(log_visits / (double)(i64)visits);
+        if (best == 0 || score > best_score) {
+            best = child;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+static void mcts_select(struct mcts *mcts, struct mcts_job *job) {
+    board_copy(mcts, mcts->select_board, mcts->board);
+    struct mcts_node *node = mcts->root;
+    node->pending += 1;
+    job->path[0] = node;
+    job->path_len = 1;
+    while (job->path_len < MCTS_MAX_PATH) {
+        if (!node->expanded) {
+            mcts_expand(mcts, node);
+        }
+        if (node->children_len == 0) {
+            break;
+        }
+        struct mcts_node *child = mcts_best_child(node);
+        i32 fresh = child->visits + child->pending == 0;
+        child->pending += 1;
+        cell_set(mcts, mcts->select_board, child->x, child->y);
+        job->path[job->path_len] = child;
+        job->path_len += 1;
+        node = child;
+        if (fresh) {
+            break;
+        }
+    }
+}
+
+static void mcts_backpropagate(struct mcts_job *job) {
+    for (i32 i = 0; i < job->path_len; ++i) {
+        struct mcts_node *node = job->path[i];
+        node->pending -= 1;
+        node->visits += 1;
+        node->reward += job->reward;
+    }
+}
+
+static void mcts_set_root(struct mcts *mcts, i32 x, i32 y, i32 vx, i32 vy) {
+    struct mcts_node *reused = 0;
+    if (mcts->root != 0) {
+        for (i32 i = 0; i < mcts->root->children_len; ++i) {
+            struct mcts_node *child = mcts->root->children[i];
+            if (
+                child->x == x &&
+                child->y == y &&
+                child->vx == vx &&
+                child->vy == vy
+            ) {
+                reused = child;
+                break;
+            }
+        }
+    }
+
+    i32 next = mcts->pool ^ 1;
+    struct arena *pool = &mcts->pools[next];
+    arena_reset(pool);
+    if (reused != 0) {
+        mcts->root = mcts_copy(pool, reused);
+    } else {
+        mcts->root = mcts_node_new(pool, x, y, vx, vy);
+    }
+    mcts->pool = next;
+}
+
+u64 mcts_choose(
+    struct mcts *mcts,
+    u64 *board,
+    i32 x,
+    i32 y,
+    i32 vx,
+    i32 vy,
+    i32 *turn_vx,
+    i32 *turn_vy
+) {
+    i64 deadline = mcts_now_ns() + mcts->budget_ns;
+    board_copy(mcts, mcts->board, board);
+    cell_set(mcts, mcts->board, x, y);
+    mcts_set_root(mcts, x, y, vx, vy);
+
+    *turn_vx = vx;
+    *turn_vy = vy;
+    if (mcts->root == 0) {
+        return 0;
+    }
+
+    u64 rollouts = 0;
+    do {
+        mcts->jobs_len = mcts->workers_len * MCTS_JOBS_PER_WORKER;
+        for (i32 i = 0; i < mcts->jobs_len; ++i) {
+            mcts_select(mcts, &mcts->jobs[i]);
+        }
+        mcts_run_jobs(mcts);
+        for (i32 i = 0; i < mcts->jobs_len; ++i) {
+            mcts_backpropagate(&mcts->jobs[i]);
+        }
+        rollouts += (u64)mcts->jobs_len;
+    } while (mcts_now_ns() < deadline);
+    mcts->rollouts += rollouts;
+
+    struct mcts_node *best = 0;
+    for (i32 i = 0; i < mcts->root->children_len; ++i) {
+        struct mcts_node *child = mcts->root->children[i];
+        if (best == 0 || child->visits > best->visits) {
+            best = child;
+        }
+    }
+    if (best != 0) {
+        *turn_vx = best->vx;
+        *turn_vy = best->vy;
+    }
+    return rollouts;
+}
@@ -1,21 +1,55 @@
-typedef long i64;
-typedef unsigned long u64;
+#include "dumb_cycle.h"
 
-struct arena {
-    char *start;
-    char *end;
-};
+void arena_init(struct arena *arena, char *mem, i64 size) {
+    arena->start = mem;
+    arena->end = mem + size;
+    arena->base = mem;
+    arena->high = mem;
+    arena->failures = 0;
+}
 
-void *alloc(struct arena *arena, i64 size) {
+void *alloc_uninit(struct arena *arena, i64 size) {
     i64 available = arena->end - arena->start;
     i64 padding = -(i64)arena->start & (16 - 1);
     if (size > (available - padding)) {
+        arena->failures += 1;
         return 0;
     }
     char *p = arena->start + padding;
     arena->start = p + size;
-    for (i64 i = 0; i < size; ++i) {
-        p[i] = 0;
+    if (arena->start > arena->high) {
+        arena->high = arena->start;
     }
     return p;
 }
+
+void *alloc(struct arena *arena, i64 size) {
+    char *p = alloc_uninit(arena, size);
+    if (p == 0) {
+        return 0;
+    }
+    memset(p, 0, (u64)size);
+    return p;
+}
+
+i32 arena_split(struct arena *arena, struct arena *sub, i64 size) {
+    char *mem = alloc_uninit(arena, size);
+    if (mem == 0) {
+        return -1;
+    }
+    arena_init(sub, mem, size);
+    return 0;
+}
+
+struct arena_checkpoint arena_save(struct arena *arena) {
+    struct arena_checkpoint checkpoint = { .start = arena->start };
+    return checkpoint;
+}
+
+void arena_restore(struct arena *arena, struct arena_checkpoint checkpoint) {
+    arena->start = checkpoint.start;
+}
+
+void arena_reset(struct arena *arena) {
+    arena->start = arena->base;
+}
@@ -0,0 +1,227 @@
+.text
+.global memset
+memset:
+    movq %rdi, %r8
+    movl %esi, %eax
+    movq %rdx, %rcx
+    rep stosb
+    movq %r8, %rax
+    ret
+.type memset, @function
+.size memset, .-memset
+
+.global memcpy
+memcpy:
+    movq %rdi, %rax
+    movq %rdx, %rcx
+    rep movsb
+    ret
+.type memcpy, @function
+.size memcpy, .-memcpy
+
+.global memset_avx2
+memset_avx2:
+    movq %rdi, %rax
+    vmovd %esi, %xmm0
+    vpbroadcastb %xmm0, %ymm0
+1:
+    testq $31, %rdi
+    jz 2f
+    testq %rdx, %rdx
+    jz 9f
+    movb %sil, (%rdi)
+    incq %rdi
+    decq %rdx
+    jmp 1b
+2:
+    cmpq $128, %rdx
+    jb 3f
+    vmovdqa %ymm0, (%rdi)
+    vmovdqa %ymm0, 32(%rdi)
+    vmovdqa %ymm0, 64(%rdi)
+    vmovdqa %ymm0, 96(%rdi)
+    addq $128, %rdi
+    subq $128, %rdx
+    jmp 2b
+3:
+    cmpq $32, %rdx
+    jb 4f
+    vmovdqa %ymm0, (%rdi)
+    addq $32, %rdi
+    subq $32, %rdx
+    jmp 3b
+4:
+    testq %rdx, %rdx
+    jz 9f
+    movb %sil, (%rdi)
+    incq %rdi
+    decq %rdx
+    jmp 4b
+9:
+    vzeroupper
+    ret
+.type memset_avx2, @function
+.size memset_avx2, .-memset_avx2
+
+.global memcpy_avx2
+memcpy_avx2:
+    movq %rdi, %rax
+1:
+    testq $31, %rdi
+    jz 2f
+    testq %rdx, %rdx
+    jz 9f
+    movb (%rsi), %cl
+    movb %cl, (%rdi)
+    incq %rsi
+    incq %rdi
+    decq %rdx
+    jmp 1b
+2:
+    cmpq $128, %rdx
+    jb 3f
+    vmovdqu (%rsi), %ymm0
+    vmovdqu 32(%rsi), %ymm1
+    vmovdqu 64(%rsi), %ymm2
+    vmovdqu 96(%rsi), %ymm3
+    vmovdqa %ymm0, (%rdi)
+    vmovdqa %ymm1, 32(%rdi)
+    vmovdqa %ymm2, 64(%rdi)
+    vmovdqa %ymm3, 96(%rdi)
+    addq $128, %rsi
+    addq $128, %rdi
+    subq $128, %rdx
+    jmp 2b
+3:
+    cmpq $32, %rdx
+    jb 4f
+    vmovdqu (%rsi), %ymm0
+    vmovdqa %ymm0, (%rdi)
+    addq $32, %rsi
+    addq $32, %rdi
+    subq $32, %rdx
+    jmp 3b
+4:
+    testq %rdx, %rdx
+    jz 9f
+    movb (%rsi), %cl
+    movb %cl, (%rdi)
+    incq %rsi
+    incq %rdi
+    decq %rdx
+    jmp 4b
+9:
+    vzeroupper
+    ret
+.type memcpy_avx2, @function
+.size memcpy_avx2, .-memcpy_avx2
+
+.global memset_stream
+memset_stream:
+    movq %rdi, %rax
+    movzbl %sil, %ecx
+    imull $0x01010101, %ecx, %ecx
+    movd %ecx, %xmm0
+    pshufd $0, %xmm0, %xmm0
+1:
+    testq $15, %rdi
+    jz 2f
+    testq %rdx, %rdx
+    jz 9f
+    movb %sil, (%rdi)
+    incq %rdi
+    decq %rdx
+    jmp 1b
+2:
+    cmpq $64, %rdx
+    jb 3f
+    movntdq %xmm0, (%rdi)
+    movntdq %xmm0, 16(%rdi)
+    movntdq %xmm0, 32(%rdi)
+    movntdq %xmm0, 48(%rdi)
+    addq $64, %rdi
+    subq $64, %rdx
+    jmp 2b
+3:
+    cmpq $16, %rdx
+    jb 4f
+    movntdq %xmm0, (%rdi)
+    addq $16, %rdi
+    subq $16, %rdx
+    jmp 3b
+4:
+    testq %rdx, %rdx
+    jz 9f
+    movb %sil, (%rdi)
+    incq %rdi
+    decq %rdx
+    jmp 4b
+9:
+    sfence
+    ret
+.type memset_stream, @function
+.size memset_stream, .-memset_stream
+
+.global memcpy_stream
+memcpy_stream:
+    movq %rdi, %rax
+1:
+    testq $15, %rdi
+    jz 2f
+    testq %rdx, %rdx
+    jz 9f
+    movb (%rsi), %cl
+    movb %cl, (%rdi)
+    incq %rsi
+    incq %rdi
+    decq %rdx
+    jmp 1b
+2:
+    cmpq $64, %rdx
+    jb 3f
+    movdqu (%rsi), %xmm0
+    movdqu 16(%rsi), %xmm1
+    movdqu 32(%rsi), %xmm2
+    movdqu 48(%rsi), %xmm3
+    movntdq %xmm0, (%rdi)
+    movntdq %xmm1, 16(%rdi)
+    movntdq %xmm2, 32(%rdi)
+    movntdq %xmm3, 48(%rdi)
+    addq $64, %rsi
+    addq $64, %rdi
+    subq $64, %rdx
+    jmp 2b
+3:
+    cmpq $16, %rdx
+    jb 4f
+    movdqu (%rsi), %xmm0
+    movntdq %xmm0, (%rdi)
+    addq $16, %rsi
+    addq $16, %rdi
+    subq $16, %rdx
+    jmp 3b
+4:
+    testq %rdx, %rdx
+    jz 9f
+    movb (%rsi), %cl
+    movb %cl, (%rdi)
+    incq %rsi
+    incq %rdi
+    decq %rdx
+    jmp 4b
+9:
+    sfence
+    ret
+.type memcpy_stream, @function
+.size memcpy_stream, .-memcpy_stream
+
+.global fill32_rep
+fill32_rep:
+    movl %edx, %eax
+    movq %rsi, %rcx
+    rep stosl
+    ret
+.type fill32_rep, @function
+.size fill32_rep, .-fill32_rep
+
+.section .note.GNU-stack,"",@progbits
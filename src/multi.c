@@ -0,0 +1,210 @@
+#include "dumb_cycle.h"
+
+static i32 *alloc_i32s(struct arena *arena, i32 len) {
+    return alloc(arena, len * (i64)sizeof(i32));
+}
+
+i32 match_init(
+    struct match *match,
+    struct arena *arena,
+    i32 width,
+    i32 height,
+    i32 cycles_len
+) {
+    if (
+        width < BOARD_MIN_SIZE ||
+        width > BOARD_MAX_SIZE ||
+        height < BOARD_MIN_SIZE ||
+        height > BOARD_MAX_SIZE ||
+        cycles_len <= 0 ||
+        cycles_len > (width / 2) * (height / 2)
+    ) {
+        return -1;
+    }
+
+    i32 cells = width * height;
+    match->width = width;
+    match->height = height;
+    match->row_words = (width + 63) / 64;
+    match->cycles_len = cycles_len;
+    match->alive_len = 0;
+    match->generation = 0;
+    match->board = alloc(
+        arena,
+        height * match->row_words * (i64)sizeof(u64)
+    );
+    match->claims = alloc(arena, cells * (i64)sizeof(u32));
+    match->claim_owners = alloc_i32s(arena, cells);
+    match->alive = alloc_i32s(arena, cycles_len);
+    match->x = alloc_i32s(arena, cycles_len);
+    match->y = alloc_i32s(arena, cycles_len);
+    match->vx = alloc_i32s(arena, cycles_len);
+    match->vy = alloc_i32s(arena, cycles_len);
+    match->nvx = alloc_i32s(arena, cycles_len);
+    match->nvy = alloc_i32s(arena, cycles_len);
+    match->nnvx = alloc_i32s(arena, cycles_len);
+    match->nnvy = alloc_i32s(arena, cycles_len);
+    match->dead = alloc(arena, cycles_len);
+    if (
+        match->board == 0 ||
+        match->claims == 0 ||
+        match->claim_owners == 0 ||
+        match->alive == 0 ||
+        match->x == 0 ||
+        match->y == 0 ||
+        match->vx == 0 ||
+        match->vy == 0 ||
+        match->nvx == 0 ||
+        match->nvy == 0 ||
+        match->nnvx == 0 ||
+        match->nnvy == 0 ||
+        match->dead == 0
+    ) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static i32 match_columns(struct match *match) {
+    i64 cycles_len = match->cycles_len;
+    i32 max_rows = match->height / 2;
+    i32 columns = 1;
+    while (
+        (i64)columns * columns * match->height < cycles_len * match->width
+    ) {
+        columns += 1;
+    }
+    if ((i64)columns * max_rows < cycles_len) {
+        columns = (i32)((cycles_len + max_rows - 1) / max_rows);
+    }
+    if (columns > match->width / 2) {
+        columns = match->width / 2;
+    }
+    return columns;
+}
+
+void match_reset(struct match *match) {
+    memset(
+        match->board,
+        0,
+        (u64)(match->height * match->row_words) * sizeof(u64)
+    );
+
+    i32 columns = match_columns(match);
+    i32 rows = (match->cycles_len + columns - 1) / columns;
+    i32 spacing_x = match->width / columns;
+    i32 spacing_y = match->height / rows;
+
+    i32 directions[4][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+    for (i32 i = 0; i < match->cycles_len; ++i) {
+        i32 x = (i % columns) * spacing_x + spacing_x / 2;
+        i32 y = (i / columns) * spacing_y + spacing_y / 2;
+        i32 vx = directions[i % 4][0];
+        i32 vy = directions[i % 4][1];
+        match->x[i] = x;
+        match->y[i] = y;
+        match->vx[i] = vx;
+        match->vy[i] = vy;
+        match->nvx[i] = vx;
+        match->nvy[i] = vy;
+        match->nnvx[i] = vx;
+        match->nnvy[i] = vy;
+        match->dead[i] = 0;
+        match->alive[i] = i;
+        match->board[y * match->row_words + x / 64] |= 1UL << (x % 64);
+    }
+    match->alive_len = match->cycles_len;
+}
+
+i32 match_cell_free(struct match *match, i32 x, i32 y) {
+    if (x < 0 || x >= match->width || y < 0 || y >= match->height) {
+        return 0;
+    }
+    u64 word = match->board[y * match->row_words + x / 64];
+    return ((word >> (x % 64)) & 1) == 0;
+}
+
+i32 match_turn(struct match *match, i32 cycle, i32 vx, i32 vy) {
+    i32 *nvx = &match->nvx[cycle];
+    i32 *nvy = &match->nvy[cycle];
+    if (*nvx == match->vx[cycle] && *nvy == match->vy[cycle]) {
+        if (match->vx[cycle] != -vx || match->vy[cycle] != -vy) {
+            *nvx = vx;
+            *nvy = vy;
+            match->nnvx[cycle] = vx;
+            match->nnvy[cycle] = vy;
+            return 2;
+        }
+    } else if (*nvx != -vx || *nvy != -vy) {
+        match->nnvx[cycle] = vx;
+        match->nnvy[cycle] = vy;
+        return 1;
+    }
+    return 0;
+}
+
+i32 match_update(struct match *match) {
+    match->generation += 1;
+    if (match->generation == 0) {
+        memset(
+            match->claims,
+            0,
+            (u64)(match->width * match->height) * sizeof(*match->claims)
+        );
+        match->generation = 1;
+    }
+
+    u32 generation = match->generation;
+    i32 width = match->width;
+    i32 height = match->height;
+    i32 row_words = match->row_words;
+    u64 *board = match->board;
+    u32 *claims = match->claims;
+    i32 *claim_owners = match->claim_owners;
+    char *dead = match->dead;
+
+    for (i32 i = 0; i < match->alive_len; ++i) {
+        i32 cycle = match->alive[i];
+        i32 x = match->x[cycle] + match->vx[cycle];
+        i32 y = match->y[cycle] + match->vy[cycle];
+        match->x[cycle] = x;
+        match->y[cycle] = y;
+        match->vx[cycle] = match->nvx[cycle];
+        match->vy[cycle] = match->nvy[cycle];
+        match->nvx[cycle] = match->nnvx[cycle];
+        match->nvy[cycle] = match->nnvy[cycle];
+
+        if (x < 0 || x >= width || y < 0 || y >= height) {
+            dead[cycle] = 1;
+            continue;
+        }
+        if (((board[y * row_words + x / 64] >> (x % 64)) & 1) != 0) {
+            dead[cycle] = 1;
+            continue;
+        }
+        i32 cell = y * width + x;
+        if (claims[cell] == generation) {
+            dead[cycle] = 1;
+            dead[claim_owners[cell]] = 1;
+            continue;
+        }
+        claims[cell] = generation;
+        claim_owners[cell] = cycle;
+    }
+
+    i32 alive_len = 0;
+    for (i32 i = 0; i < match->alive_len; ++i) {
+        i32 cycle = match->alive[i];
+        if (dead[cycle]) {
+            continue;
+        }
+        i32 x = match->x[cycle];
+        board[match->y[cycle] * row_words + x / 64] |= 1UL << (x % 64);
+        match->alive[alive_len] = cycle;
+        alive_len += 1;
+    }
+    match->alive_len = alive_len;
+
+    return alive_len;
+}
@@ -0,0 +1,51 @@
+#include "dumb_cycle.h"
+
+void print_flush(struct print_buffer *out) {
+    i64 written = 0;
+    while (written < out->len) {
+        i64 len = write(out->fd, out->bytes + written, out->len - written);
+        if (len <= 0) {
+            break;
+        }
+        written += len;
+    }
+    out->len = 0;
+}
+
+void print_char(struct print_buffer *out, char c) {
+    if (out->len == (i64)sizeof(out->bytes)) {
+        print_flush(out);
+    }
+    out->bytes[out->len] = c;
+    out->len += 1;
+}
+
+void print_str(struct print_buffer *out, char *s) {
+    while (*s != 0) {
+        print_char(out, *s);
+        s += 1;
+    }
+}
+
+void print_u64(struct print_buffer *out, u64 value) {
+    char digits[20];
+    i32 len = 0;
+    do {
+        digits[len] = (char)('0' + value % 10);
+        value /= 10;
+        len += 1;
+    } while (value != 0);
+    while (len > 0) {
+        len -= 1;
+        print_char(out, digits[len]);
+    }
+}
+
+void print_i64(struct print_buffer *out, i64 value) {
+    if (value < 0) {
+        print_char(out, '-');
+        print_u64(out, (u64)0 - (u64)value);
+        return;
+    }
+    print_u64(out, (u64)value);
+}
@@ -0,0 +1,388 @@
+.text
+.global cpu_features
+cpu_features:
+    pushq %rbx
+    xorl %r8d, %r8d
+    xorl %eax, %eax
+    cpuid
+    cmpl $7, %eax
+    jb 1f
+    movl $1, %eax
+    cpuid
+    andl $0x18000000, %ecx
+    cmpl $0x18000000, %ecx
+    jne 1f
+    xorl %ecx, %ecx
+    xgetbv
+    andl $6, %eax
+    cmpl $6, %eax
+    jne 1f
+    movl $7, %eax
+    xorl %ecx, %ecx
+    cpuid
+    testl $0x20, %ebx
+    jz 1f
+    orl $1, %r8d
+1:
+    movl %r8d, %eax
+    popq %rbx
+    ret
+.type cpu_features, @function
+.size cpu_features, .-cpu_features
+
+.global fill32_sse2
+fill32_sse2:
+    movd %edx, %xmm0
+    pshufd $0, %xmm0, %xmm0
+1:
+    testq $15, %rdi
+    jz 2f
+    testq %rsi, %rsi
+    jz 9f
+    movl %edx, (%rdi)
+    addq $4, %rdi
+    decq %rsi
+    jmp 1b
+2:
+    cmpq $16, %rsi
+    jb 3f
+    movdqa %xmm0, (%rdi)
+    movdqa %xmm0, 16(%rdi)
+    movdqa %xmm0, 32(%rdi)
+    movdqa %xmm0, 48(%rdi)
+    addq $64, %rdi
+    subq $16, %rsi
+    jmp 2b
+3:
+    cmpq $4, %rsi
+    jb 4f
+    movdqa %xmm0, (%rdi)
+    addq $16, %rdi
+    subq $4, %rsi
+    jmp 3b
+4:
+    testq %rsi, %rsi
+    jz 9f
+    movl %edx, (%rdi)
+    addq $4, %rdi
+    decq %rsi
+    jmp 4b
+9:
+    ret
+.type fill32_sse2, @function
+.size fill32_sse2, .-fill32_sse2
+
+.global fill32_avx2
+fill32_avx2:
+    vmovd %edx, %xmm0
+    vpbroadcastd %xmm0, %ymm0
+1:
+    testq $31, %rdi
+    jz 2f
+    testq %rsi, %rsi
+    jz 9f
+    movl %edx, (%rdi)
+    addq $4, %rdi
+    decq %rsi
+    jmp 1b
+2:
+    cmpq $32, %rsi
+    jb 3f
+    vmovdqa %ymm0, (%rdi)
+    vmovdqa %ymm0, 32(%rdi)
+    vmovdqa %ymm0, 64(%rdi)
+    vmovdqa %ymm0, 96(%rdi)
+    addq $128, %rdi
+    subq $32, %rsi
+    jmp 2b
+3:
+    cmpq $8, %rsi
+    jb 4f
+    vmovdqa %ymm0, (%rdi)
+    addq $32, %rdi
+    subq $8, %rsi
+    jmp 3b
+4:
+    testq %rsi, %rsi
+    jz 9f
+    movl %edx, (%rdi)
+    addq $4, %rdi
+    decq %rsi
+    jmp 4b
+9:
+    vzeroupper
+    ret
+.type fill32_avx2, @function
+.size fill32_avx2, .-fill32_avx2
+
+.global copy32_sse2
+copy32_sse2:
+1:
+    testq $15, %rdi
+    jz 2f
+    testq %rdx, %rdx
+    jz 9f
+    movl (%rsi), %eax
+    movl %eax, (%rdi)
+    addq $4, %rsi
+    addq $4, %rdi
+    decq %rdx
+    jmp 1b
+2:
+    cmpq $16, %rdx
+    jb 3f
+    movdqu (%rsi), %xmm0
+    movdqu 16(%rsi), %xmm1
+    movdqu 32(%rsi), %xmm2
+    movdqu 48(%rsi), %xmm3
+    movdqa %xmm0, (%rdi)
+    movdqa %xmm1, 16(%rdi)
+    movdqa %xmm2, 32(%rdi)
+    movdqa %xmm3, 48(%rdi)
+    addq $64, %rsi
+    addq $64, %rdi
+    subq $16, %rdx
+    jmp 2b
+3:
+    cmpq $4, %rdx
+    jb 4f
+    movdqu (%rsi), %xmm0
+    movdqa %xmm0, (%rdi)
+    addq $16, %rsi
+    addq $16, %rdi
+    subq $4, %rdx
+    jmp 3b
+4:
+    testq %rdx, %rdx
+    jz 9f
+    movl (%rsi), %eax
+    movl %eax, (%rdi)
+    addq $4, %rsi
+    addq $4, %rdi
+    decq %rdx
+    jmp 4b
+9:
+    ret
+.type copy32_sse2, @function
+.size copy32_sse2, .-copy32_sse2
+
+.global copy32_avx2
+copy32_avx2:
+1:
+    testq $31, %rdi
+    jz 2f
+    testq %rdx, %rdx
+    jz 9f
+    movl (%rsi), %eax
+    movl %eax, (%rdi)
+    addq $4, %rsi
+    addq $4, %rdi
+    decq %rdx
+    jmp 1b
+2:
+    cmpq $32, %rdx
+    jb 3f
+    vmovdqu (%rsi), %ymm0
+    vmovdqu 32(%rsi), %ymm1
+    vmovdqu 64(%rsi), %ymm2
+    vmovdqu 96(%rsi), %ymm3
+    vmovdqa %ymm0, (%rdi)
+    vmovdqa %ymm1, 32(%rdi)
+    vmovdqa %ymm2, 64(%rdi)
+    vmovdqa %ymm3, 96(%rdi)
+    addq $128, %rsi
+    addq $128, %rdi
+    subq $32, %rdx
+    jmp 2b
+3:
+    cmpq $8, %rdx
+    jb 4f
+    vmovdqu (%rsi), %ymm0
+    vmovdqa %ymm0, (%rdi)
+    addq $32, %rsi
+    addq $32, %rdi
+    subq $8, %rdx
+    jmp 3b
+4:
+    testq %rdx, %rdx
+    jz 9f
+    movl (%rsi), %eax
+    movl %eax, (%rdi)
+    addq $4, %rsi
+    addq $4, %rdi
+    decq %rdx
+    jmp 4b
+9:
+    vzeroupper
+    ret
+.type copy32_avx2, @function
+.size copy32_avx2, .-copy32_avx2
+
+.global stream32_sse2
+stream32_sse2:
+1:
+    testq $15, %rdi
+    jz 2f
+    testq %rdx, %rdx
+    jz 9f
+    movl (%rsi), %eax
+    movnti %eax, (%rdi)
+    addq $4, %rsi
+    addq $4, %rdi
+    decq %rdx
+    jmp 1b
+2:
+    cmpq $16, %rdx
+    jb 3f
+    movdqu (%rsi), %xmm0
+    movdqu 16(%rsi), %xmm1
+    movdqu 32(%rsi), %xmm2
+    movdqu 48(%rsi), %xmm3
+    movntdq %xmm0, (%rdi)
+    movntdq %xmm1, 16(%rdi)
+    movntdq %xmm2, 32(%rdi)
+    movntdq %xmm3, 48(%rdi)
+    addq $64, %rsi
+    addq $64, %rdi
+    subq $16, %rdx
+    jmp 2b
+3:
+    cmpq $4, %rdx
+    jb 4f
+    movdqu (%rsi), %xmm0
+    movntdq %xmm0, (%rdi)
+    addq $16, %rsi
+    addq $16, %rdi
+    subq $4, %rdx
+    jmp 3b
+4:
+    testq %rdx, %rdx
+    jz 9f
+    movl (%rsi), %eax
+    movnti %eax, (%rdi)
+    addq $4, %rsi
+    addq $4, %rdi
+    decq %rdx
+    jmp 4b
+9:
+    sfence
+    ret
+.type stream32_sse2, @function
+.size stream32_sse2, .-stream32_sse2
+
+.global stream32_avx2
+stream32_avx2:
+1:
+    testq $31, %rdi
+    jz 2f
+    testq %rdx, %rdx
+    jz 9f
+    movl (%rsi), %eax
+    movnti %eax, (%rdi)
+    addq $4, %rsi
+    addq $4, %rdi
+    decq %rdx
+    jmp 1b
+2:
+    cmpq $32, %rdx
+    jb 3f
+    vmovdqu (%rsi), %ymm0
+    vmovdqu 32(%rsi), %ymm1
+    vmovdqu 64(%rsi), %ymm2
+    vmovdqu 96(%rsi), %ymm3
+    vmovntdq %ymm0, (%rdi)
+    vmovntdq %ymm1, 32(%rdi)
+    vmovntdq %ymm2, 64(%rdi)
+    vmovntdq %ymm3, 96(%rdi)
+    addq $128, %rsi
+    addq $128, %rdi
+    subq $32, %rdx
+    jmp 2b
+3:
+    cmpq $8, %rdx
+    jb 4f
+    vmovdqu (%rsi), %ymm0
+    vmovntdq %ymm0, (%rdi)
+    addq $32, %rsi
+    addq $32, %rdi
+    subq $8, %rdx
+    jmp 3b
+4:
+    testq %rdx, %rdx
+    jz 9f
+    movl (%rsi), %eax
+    movnti %eax, (%rdi)
+    addq $4, %rsi
+    addq $4, %rdi
+    decq %rdx
+    jmp 4b
+9:
+    sfence
+    vzeroupper
+    ret
+.type stream32_avx2, @function
+.size stream32_avx2, .-stream32_avx2
+
+.global expand32_sse2
+expand32_sse2:
+    xorl %r9d, %r9d
+1:
+    cmpq %rdx, %r9
+    jae 9f
+    testq $63, %r9
+    jnz 2f
+    movq %r9, %rax
+    shrq $6, %rax
+    movq (%rsi,%rax,8), %r10
+2:
+    movl %r10d, %eax
+    andl $1, %eax
+    shrq $1, %r10
+    movd (%r8,%rax,4), %xmm0
+    pshufd $0, %xmm0, %xmm0
+    xorl %r11d, %r11d
+3:
+    movdqu %xmm0, (%rdi,%r11,4)
+    addq $4, %r11
+    cmpq %rcx, %r11
+    jb 3b
+    leaq (%rdi,%rcx,4), %rdi
+    incq %r9
+    jmp 1b
+9:
+    ret
+.type expand32_sse2, @function
+.size expand32_sse2, .-expand32_sse2
+
+.global expand32_avx2
+expand32_avx2:
+    xorl %r9d, %r9d
+1:
+    cmpq %rdx, %r9
+    jae 9f
+    testq $63, %r9
+    jnz 2f
+    movq %r9, %rax
+    shrq $6, %rax
+    movq (%rsi,%rax,8), %r10
+2:
+    movl %r10d, %eax
+    andl $1, %eax
+    shrq $1, %r10
+    vpbroadcastd (%r8,%rax,4), %ymm0
+    xorl %r11d, %r11d
+3:
+    vmovdqu %ymm0, (%rdi,%r11,4)
+    addq $8, %r11
+    cmpq %rcx, %r11
+    jb 3b
+    leaq (%rdi,%rcx,4), %rdi
+    incq %r9
+    jmp 1b
+9:
+    vzeroupper
+    ret
+.type expand32_avx2, @function
+.size expand32_avx2, .-expand32_avx2
+
+.section .note.GNU-stack,"",@progbits
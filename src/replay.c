@@ -0,0 +1,166 @@
+#include "dumb_cycle.h"
+
+enum replay_format {
+    REPLAY_MAGIC = 0x50524344,
+    REPLAY_VERSION = 2,
+    REPLAY_TICK_SHIFT = 3,
+    REPLAY_KIND_MASK = 0x7,
+    REPLAY_KIND_END = 4,
+};
+
+enum replay_error {
+    REPLAY_ERROR_NONE = 0,
+    REPLAY_ERROR_OPEN,
+    REPLAY_ERROR_READ,
+    REPLAY_ERROR_WRITE,
+    REPLAY_ERROR_FORMAT,
+    REPLAY_ERROR_ALLOC,
+};
+
+static i32 write_all(i32 fd, char *bytes, i64 len) {
+    while (len > 0) {
+        i64 written = write(fd, bytes, len);
+        if (written <= 0) {
+            return REPLAY_ERROR_WRITE;
+        }
+        bytes += written;
+        len -= written;
+    }
+    return REPLAY_ERROR_NONE;
+}
+
+static i32 replay_writer_flush(struct replay_writer *writer) {
+    i32 error = write_all(
+        writer->fd,
+        (char *)writer->records,
+        writer->len * (i64)sizeof(*writer->records)
+    );
+    writer->len = 0;
+    return error;
+}
+
+static i32 replay_writer_push(struct replay_writer *writer, u32 record) {
+    writer->records[writer->len] = record;
+    writer->len += 1;
+    if (writer->len == (i32)(sizeof(writer->records) / sizeof(u32))) {
+        return replay_writer_flush(writer);
+    }
+    return REPLAY_ERROR_NONE;
+}
+
+i32 replay_writer_open(
+    struct replay_writer *writer,
+    char *path,
+    struct replay_header *header
+) {
+    writer->len = 0;
+    writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (writer->fd < 0) {
+        return REPLAY_ERROR_OPEN;
+    }
+    header->magic = REPLAY_MAGIC;
+    header->version = REPLAY_VERSION;
+    return write_all(writer->fd, (char *)header, sizeof(*header));
+}
+
+i32 replay_writer_turn(
+    struct replay_writer *writer,
+    u32 tick,
+    i32 vx,
+    i32 vy
+) {
+    u32 kind = 0;
+    if (vy > 0) {
+        kind = 1;
+    } else if (vx < 0) {
+        kind = 2;
+    } else if (vy < 0) {
+        kind = 3;
+    }
+    return replay_writer_push(writer, (tick << REPLAY_TICK_SHIFT) | kind);
+}
+
+i32 replay_writer_close(struct replay_writer *writer, u32 ticks) {
+    i32 error = replay_writer_push(
+        writer,
+        (ticks << REPLAY_TICK_SHIFT) | REPLAY_KIND_END
+    );
+    if (error == REPLAY_ERROR_NONE) {
+        error = replay_writer_flush(writer);
+    }
+    close(writer->fd);
+    return error;
+}
+
+i32 replay_load(struct replay *replay, struct arena *arena, char *path) {
+    i32 fd = open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        return REPLAY_ERROR_OPEN;
+    }
+
+    i64 capacity = (arena->end - arena->start) / 2;
+    char *bytes = alloc_uninit(arena, capacity);
+    if (bytes == 0) {
+        close(fd);
+        return REPLAY_ERROR_ALLOC;
+    }
+
+    i64 len = 0;
+    while (len < capacity) {
+        i64 read_len = read(fd, bytes + len, capacity - len);
+        if (read_len < 0) {
+            close(fd);
+            return REPLAY_ERROR_READ;
+        }
+        if (read_len == 0) {
+            break;
+        }
+        len += read_len;
+    }
+    close(fd);
+    arena->start = bytes + len;
+
+    struct replay_header *header = (void *)bytes;
+    if (
+        len < (i64)sizeof(*header) ||
+        (len - (i64)sizeof(*header)) % (i64)sizeof(u32) != 0 ||
+        header->magic != REPLAY_MAGIC ||
+        header->version != REPLAY_VERSION
+    ) {
+        return REPLAY_ERROR_FORMAT;
+    }
+
+    replay->header = *header;
+    replay->records = (void *)(bytes + sizeof(*header));
+    replay->records_len = (len - (i64)sizeof(*header)) / (i64)sizeof(u32);
+    replay->next = 0;
+    if (replay->records_len == 0) {
+        return REPLAY_ERROR_FORMAT;
+    }
+
+    u32 end = replay->records[replay->records_len - 1];
+    if ((end & REPLAY_KIND_MASK) != REPLAY_KIND_END) {
+        return REPLAY_ERROR_FORMAT;
+    }
+    replay->ticks = end >> REPLAY_TICK_SHIFT;
+    replay->records_len -= 1;
+
+    return REPLAY_ERROR_NONE;
+}
+
+i32 replay_turn(struct replay *replay, u32 tick, i32 *vx, i32 *vy) {
+    if (replay->next >= replay->records_len) {
+        return 0;
+    }
+    u32 record = replay->records[replay->next];
+    if ((record >> REPLAY_TICK_SHIFT) != tick) {
+        return 0;
+    }
+    replay->next += 1;
+
+    i32 directions[4][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+    u32 kind = record & 3;
+    *vx = directions[kind][0];
+    *vy = directions[kind][1];
+    return 1;
+}
@@ -77,6 +77,73 @@ syscall6:
 .type syscall6, @function
 .size syscall6, .-syscall6
 
+.global cycle_count
+cycle_count:
+    rdtsc
+    shlq $32, %rdx
+    orq %rdx, %rax
+    ret
+.type cycle_count, @function
+.size cycle_count, .-cycle_count
+
+.global clone_thread
+clone_thread:
+    andq $-16, %rsi
+    subq $16, %rsi
+    movq %r8, (%rsi)
+    movq %r9, 8(%rsi)
+    movq %rcx, %r10
+    xorl %r8d, %r8d
+    movl $56, %eax
+    syscall
+    testq %rax, %rax
+    jnz 1f
+    xorl %ebp, %ebp
+    popq %rax
+    popq %rdi
+    call *%rax
+    movl $60, %eax
+    xorl %edi, %edi
+    syscall
+    ud2
+1:
+    ret
+.type clone_thread, @function
+.size clone_thread, .-clone_thread
+
+.global futex_wait
+futex_wait:
+    movl %esi, %edx
+    xorl %esi, %esi
+    xorl %r10d, %r10d
+    movl $202, %eax
+    syscall
+    cmpq $-4095, %rax
+    jb 1f
+    negl %eax
+    ret
+1:
+    xorl %eax, %eax
+    ret
+.type futex_wait, @function
+.size futex_wait, .-futex_wait
+
+.global futex_wake
+futex_wake:
+    movl %esi, %edx
+    movl $1, %esi
+    movl $202, %eax
+    syscall
+    cmpq $-4095, %rax
+    jb 1f
+    negl %eax
+    ret
+1:
+    xorl %eax, %eax
+    ret
+.type futex_wake, @function
+.size futex_wake, .-futex_wake
+
 .extern _cstart
 .global _start
 _start:
@@ -0,0 +1,381 @@
+#include "dumb_cycle.h"
+
+enum selfplay_error {
+    SELFPLAY_ERROR_NONE = 0,
+    SELFPLAY_ERROR_ARGS,
+    SELFPLAY_ERROR_MMAP,
+    SELFPLAY_ERROR_ALLOC,
+    SELFPLAY_ERROR_BOARD,
+    SELFPLAY_ERROR_THREAD,
+    SELFPLAY_ERROR_CLOCK_GETTIME,
+};
+
+enum selfplay_limits {
+    SELFPLAY_MAX_THREADS = 256,
+    SELFPLAY_ARENA_SIZE = 1024 * 4096,
+    SELFPLAY_STACK_SIZE = 64 * 1024,
+};
+
+struct selfplay;
+
+struct selfplay_worker {
+    struct selfplay *selfplay;
+    struct arena arena;
+    struct thread thread;
+    struct game_state state;
+    struct bot bot;
+    u64 games;
+    u64 ticks;
+    u64 wall_deaths;
+    u64 trail_deaths;
+    struct histogram lengths;
+    struct histogram filled;
+    struct histogram depths;
+};
+
+struct selfplay {
+    i32 width;
+    i32 height;
+    i64 budget_ns;
+    i32 max_depth;
+    u64 seed;
+    u64 games;
+    u64 next_game;
+    i32 workers_len;
+    struct selfplay_worker *workers[SELFPLAY_MAX_THREADS];
+};
+
+static u64 selfplay_random(u64 *state) {
+    *state += 0x9e3779b97f4a7c15UL;
+    u64 z = *state;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9UL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebUL;
+    return z ^ (z >> 31);
+}
+
+static void selfplay_start(struct game_state *state, u64 *rng) {
+    clear_game(state);
+    board_row(state, state->y)[state->x / 64] = 0;
+
+    i32 directions[4][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+    u64 direction = selfplay_random(rng) % 4;
+    state->x = 1 + (i32)(selfplay_random(rng) % (u64)(state->width - 2));
+    state->y = 1 + (i32)(selfplay_random(rng) % (u64)(state->height - 2));
+    state->vx = directions[direction][0];
+    state->vy = directions[direction][1];
+    state->nvx = state->vx;
+    state->nvy = state->vy;
+    state->nnvx = state->vx;
+    state->nnvy = state->vy;
+    board_set(board_row(state, state->y), state->x);
+}
+
+static void selfplay_steer(struct selfplay_worker *worker) {
+    struct game_state *state = &worker->state;
+    i32 x = state->x + state->vx;
+    i32 y = state->y + state->vy;
+    if (
+        x < 0 ||
+        x >= state->width ||
+        y < 0 ||
+        y >= state->height ||
+        board_test(board_row(state, y), x)
+    ) {
+        return;
+    }
+
+    i32 vx, vy;
+    i32 depth = bot_choose(
+        &worker->bot,
+        state->board,
+        x,
+        y,
+        state->vx,
+        state->vy,
+        0,
+        0,
+        &vx,
+        &vy
+    );
+    histogram_record(&worker->depths, (u64)depth);
+    queue_turn(state, vx, vy);
+}
+
+static void selfplay_play(struct selfplay_worker *worker, u64 game) {
+    struct selfplay *selfplay = worker->selfplay;
+    struct game_state *state = &worker->state;
+    u64 rng = selfplay->seed ^ (game * 0xd1342543de82ef95UL);
+    selfplay_start(state, &rng);
+
+    u64 ticks = 0;
+    while (!state->dead) {
+        selfplay_steer(worker);
+        update_game(state);
+        ticks += 1;
+    }
+
+    if (
+        state->x < 0 ||
+        state->x >= state->width ||
+        state->y < 0 ||
+        state->y >= state->height
+    ) {
+        worker->wall_deaths += 1;
+    } else {
+        worker->trail_deaths += 1;
+    }
+    u64 cells = (u64)state->width * (u64)state->height;
+    worker->games += 1;
+    worker->ticks += ticks;
+    histogram_record(&worker->lengths, ticks);
+    histogram_record(&worker->filled, ticks * 1000 / cells);
+}
+
+static void selfplay_run(void *arg) {
+    struct selfplay_worker *worker = arg;
+    struct selfplay *selfplay = worker->selfplay;
+    while (1) {
+        u64 game = __atomic_fetch_add(
+            &selfplay->next_game,
+            1,
+            __ATOMIC_RELAXED
+        );
+        if (game >= selfplay->games) {
+            return;
+        }
+        selfplay_play(worker, game);
+    }
+}
+
+static i32 selfplay_worker_init(
+    struct selfplay *selfplay,
+    struct selfplay_worker **worker_out
+) {
+    char *mem = mmap(
+        0,
+        SELFPLAY_ARENA_SIZE,
+        PROT_WRITE | PROT_READ,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+    if (mem == 0) {
+        return SELFPLAY_ERROR_MMAP;
+    }
+
+    struct arena arena;
+    arena_init(&arena, mem, SELFPLAY_ARENA_SIZE);
+    struct selfplay_worker *worker = alloc(&arena, sizeof(*worker));
+    if (worker == 0) {
+        return SELFPLAY_ERROR_ALLOC;
+    }
+    worker->selfplay = selfplay;
+    i32 error = game_init(
+        &worker->state,
+        &arena,
+        selfplay->width,
+        selfplay->height
+    );
+    if (error != 0) {
+        return SELFPLAY_ERROR_BOARD;
+    }
+    error = bot_init(
+        &worker->bot,
+        &arena,
+        selfplay->width,
+        selfplay->height,
+        selfplay->budget_ns,
+        selfplay->max_depth
+    );
+    if (error != 0) {
+        return SELFPLAY_ERROR_ALLOC;
+    }
+    worker->arena = arena;
+
+    *worker_out = worker;
+    return SELFPLAY_ERROR_NONE;
+}
+
+static i32 str_equal(char *a, char *b) {
+    while (*a != 0 && *a == *b) {
+        a += 1;
+        b += 1;
+    }
+    return *a == *b;
+}
+
+static char *parse_u32(char *s, u32 *value) {
+    if (*s < '0' || *s > '9') {
+        return 0;
+    }
+    *value = 0;
+    while (*s >= '0' && *s <= '9') {
+        *value = *value * 10 + (u32)(*s - '0');
+        s += 1;
+    }
+    return s;
+}
+
+static char *parse_prefix(char *s, char *prefix) {
+    while (*prefix != 0) {
+        if (*s != *prefix) {
+            return 0;
+        }
+        s += 1;
+        prefix += 1;
+    }
+    return s;
+}
+
+static char *parse_size(char *s, u32 *width, u32 *height) {
+    s = parse_u32(s, width);
+    if (s == 0 || *s != 'x') {
+        return 0;
+    }
+    return parse_u32(s + 1, height);
+}
+
+static void selfplay_print(struct selfplay *selfplay, i64 elapsed) {
+    struct selfplay_worker *total = selfplay->workers[0];
+    for (i32 i = 1; i < selfplay->workers_len; ++i) {
+        struct selfplay_worker *worker = selfplay->workers[i];
+        total->games += worker->games;
+        total->ticks += worker->ticks;
+        total->wall_deaths += worker->wall_deaths;
+        total->trail_deaths += worker->trail_deaths;
+        histogram_merge(&total->lengths, &worker->lengths);
+        histogram_merge(&total->filled, &worker->filled);
+        histogram_merge(&total->depths, &worker->depths);
+    }
+    if (elapsed <= 0) {
+        elapsed = 1;
+    }
+
+    struct print_buffer out;
+    out.fd = STDOUT;
+    out.len = 0;
+    print_str(&out, "games=");
+    print_u64(&out, total->games);
+    print_str(&out, " threads=");
+    print_u64(&out, (u64)selfplay->workers_len);
+    print_str(&out, " elapsed_ns=");
+    print_u64(&out, (u64)elapsed);
+    print_str(&out, " games_per_sec=");
+    print_u64(&out, total->games * 1000UL * 1000UL * 1000UL / (u64)elapsed);
+    print_str(&out, " ticks_per_sec=");
+    print_u64(&out, total->ticks * 1000UL * 1000UL * 1000UL / (u64)elapsed);
+    print_str(&out, " wall_deaths=");
+    print_u64(&out, total->wall_deaths);
+    print_str(&out, " trail_deaths=");
+    print_u64(&out, total->trail_deaths);
+    print_str(&out, "\n");
+    histogram_print(&out, "game length", "ticks", &total->lengths);
+    histogram_print(&out, "board filled", "per mille", &total->filled);
+    histogram_print(&out, "bot depth", "plies", &total->depths);
+    print_flush(&out);
+}
+
+i32 main(i32 argc, char **argv) {
+    u32 threads = (u32)cpu_count();
+    u32 games = 1000;
+    u32 board_width = 90;
+    u32 board_height = 90;
+    u32 budget = 0;
+    u32 depth = 2;
+    u32 seed = 1;
+    for (i32 i = 1; i < argc; ++i) {
+        char *value;
+        if ((value = parse_prefix(argv[i], "--threads=")) != 0) {
+            value = parse_u32(value, &threads);
+            if (
+                value == 0 ||
+                *value != 0 ||
+                threads == 0 ||
+                threads > SELFPLAY_MAX_THREADS
+            ) {
+                return SELFPLAY_ERROR_ARGS;
+            }
+        } else if ((value = parse_prefix(argv[i], "--games=")) != 0) {
+            value = parse_u32(value, &games);
+            if (value == 0 || *value != 0) {
+                return SELFPLAY_ERROR_ARGS;
+            }
+        } else if ((value = parse_prefix(argv[i], "--board=")) != 0) {
+            value = parse_size(value, &board_width, &board_height);
+            if (value == 0 || *value != 0) {
+                return SELFPLAY_ERROR_ARGS;
+            }
+        } else if ((value = parse_prefix(argv[i], "--bot=")) != 0) {
+            value = parse_u32(value, &budget);
+            if (value == 0 || *value != 0) {
+                return SELFPLAY_ERROR_ARGS;
+            }
+        } else if ((value = parse_prefix(argv[i], "--depth=")) != 0) {
+            value = parse_u32(value, &depth);
+            if (value == 0 || *value != 0 || depth > BOT_MAX_DEPTH) {
+                return SELFPLAY_ERROR_ARGS;
+            }
+        } else if ((value = parse_prefix(argv[i], "--seed=")) != 0) {
+            value = parse_u32(value, &seed);
+            if (value == 0 || *value != 0) {
+                return SELFPLAY_ERROR_ARGS;
+            }
+        } else if (!str_equal(argv[i], "--")) {
+            return SELFPLAY_ERROR_ARGS;
+        }
+    }
+    if (threads > SELFPLAY_MAX_THREADS) {
+        threads = SELFPLAY_MAX_THREADS;
+    }
+
+    struct selfplay selfplay;
+    selfplay.width = (i32)board_width;
+    selfplay.height = (i32)board_height;
+    selfplay.budget_ns = budget;
+    selfplay.max_depth = (i32)depth;
+    selfplay.seed = seed;
+    selfplay.games = games;
+    selfplay.next_game = 0;
+    selfplay.workers_len = (i32)threads;
+    for (i32 i = 0; i < selfplay.workers_len; ++i) {
+        i32 error = selfplay_worker_init(&selfplay, &selfplay.workers[i]);
+        if (error != SELFPLAY_ERROR_NONE) {
+            return error;
+        }
+    }
+
+    struct timespec start, end;
+    i32 error = clock_gettime(CLOCK_MONOTONIC, &start);
+    if (error != 0) {
+        return SELFPLAY_ERROR_CLOCK_GETTIME;
+    }
+    for (i32 i = 1; i < selfplay.workers_len; ++i) {
+        struct selfplay_worker *worker = selfplay.workers[i];
+        char *stack = alloc(&worker->arena, SELFPLAY_STACK_SIZE);
+        if (stack == 0) {
+            return SELFPLAY_ERROR_ALLOC;
+        }
+        error = thread_create(
+            &worker->thread,
+            stack,
+            SELFPLAY_STACK_SIZE,
+            selfplay_run,
+            worker
+        );
+        if (error != 0) {
+            return SELFPLAY_ERROR_THREAD;
+        }
+    }
+    selfplay_run(selfplay.workers[0]);
+    for (i32 i = 1; i < selfplay.workers_len; ++i) {
+        thread_join(&selfplay.workers[i]->thread);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    selfplay_print(&selfplay, time_since_ns(&end, &start));
+    return SELFPLAY_ERROR_NONE;
+}
+
+void _cstart(i32 argc, char **argv) {
+    exit(main(argc, argv));
+}
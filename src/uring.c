@@ -0,0 +1,281 @@
+#include "dumb_cycle.h"
+
+struct io_sqring_offsets {
+    u32 head;
+    u32 tail;
+    u32 ring_mask;
+    u32 ring_entries;
+    u32 flags;
+    u32 dropped;
+    u32 array;
+    u32 resv1;
+    u64 user_addr;
+};
+
+struct io_cqring_offsets {
+    u32 head;
+    u32 tail;
+    u32 ring_mask;
+    u32 ring_entries;
+    u32 overflow;
+    u32 cqes;
+    u32 flags;
+    u32 resv1;
+    u64 user_addr;
+};
+
+struct io_uring_params {
+    u32 sq_entries;
+    u32 cq_entries;
+    u32 flags;
+    u32 sq_thread_cpu;
+    u32 sq_thread_idle;
+    u32 features;
+    u32 wq_fd;
+    u32 resv[3];
+    struct io_sqring_offsets sq_off;
+    struct io_cqring_offsets cq_off;
+};
+
+struct io_uring_sqe {
+    u8 opcode;
+    u8 flags;
+    u16 ioprio;
+    i32 fd;
+    u64 off;
+    u64 addr;
+    u32 len;
+    u32 op_flags;
+    u64 user_data;
+    u16 buf_index;
+    u16 personality;
+    i32 splice_fd_in;
+    u64 pad[2];
+};
+
+struct io_uring_cqe {
+    u64 user_data;
+    i32 res;
+    u32 flags;
+};
+
+enum io_uring_mmap_offset {
+    IORING_OFF_SQ_RING = 0,
+    IORING_OFF_SQES = 0x10000000,
+};
+
+enum io_uring_feature {
+    IORING_FEAT_SINGLE_MMAP = 1,
+};
+
+enum io_uring_enter_flag {
+    IORING_ENTER_GETEVENTS = 1,
+};
+
+enum io_uring_op {
+    IORING_OP_POLL_ADD = 6,
+    IORING_OP_TIMEOUT = 11,
+    IORING_OP_TIMEOUT_REMOVE = 12,
+    IORING_OP_READ = 22,
+};
+
+enum io_uring_timeout_flag {
+    IORING_TIMEOUT_ABS = 1,
+};
+
+i32 uring_init(struct uring *ring, u32 entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    ring->fd = io_uring_setup(entries, &params);
+    if (ring->fd < 0) {
+        return ring->fd;
+    }
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0) {
+        close(ring->fd);
+        return -1;
+    }
+
+    i64 sq_size = params.sq_off.array +
+        params.sq_entries * (i64)sizeof(u32);
+    i64 cq_size = params.cq_off.cqes +
+        params.cq_entries * (i64)sizeof(struct io_uring_cqe);
+    i64 ring_size = (sq_size > cq_size) ? sq_size : cq_size;
+    char *rings = mmap(
+        0,
+        ring_size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        ring->fd,
+        IORING_OFF_SQ_RING
+    );
+    ring->sqes = mmap(
+        0,
+        params.sq_entries * (i64)sizeof(struct io_uring_sqe),
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        ring->fd,
+        IORING_OFF_SQES
+    );
+    if (rings == 0 || ring->sqes == 0) {
+        close(ring->fd);
+        return -1;
+    }
+
+    ring->sq_head = (u32 *)(void *)(rings + params.sq_off.head);
+    ring->sq_tail = (u32 *)(void *)(rings + params.sq_off.tail);
+    ring->sq_mask = *(u32 *)(void *)(rings + params.sq_off.ring_mask);
+    ring->sq_entries = params.sq_entries;
+    ring->cq_head = (u32 *)(void *)(rings + params.cq_off.head);
+    ring->cq_tail = (u32 *)(void *)(rings + params.cq_off.tail);
+    ring->cq_mask = *(u32 *)(void *)(rings + params.cq_off.ring_mask);
+    ring->cqes = (void *)(rings + params.cq_off.cqes);
+
+    u32 *array = (u32 *)(void *)(rings + params.sq_off.array);
+    for (u32 i = 0; i < params.sq_entries; ++i) {
+        array[i] = i;
+    }
+    return 0;
+}
+
+static struct io_uring_sqe *uring_sqe(
+    struct uring *ring,
+    u8 opcode,
+    i32 fd,
+    u64 user_data
+) {
+    u32 head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    u32 tail = *ring->sq_tail;
+    if (tail - head >= ring->sq_entries) {
+        return 0;
+    }
+
+    struct io_uring_sqe *sqe = &ring->sqes[tail & ring->sq_mask];
+    sqe->opcode = opcode;
+    sqe->flags = 0;
+    sqe->ioprio = 0;
+    sqe->fd = fd;
+    sqe->off = 0;
+    sqe->addr = 0;
+    sqe->len = 0;
+    sqe->op_flags = 0;
+    sqe->user_data = user_data;
+    sqe->buf_index = 0;
+    sqe->personality = 0;
+    sqe->splice_fd_in = 0;
+    sqe->pad[0] = 0;
+    sqe->pad[1] = 0;
+    return sqe;
+}
+
+static void uring_push(struct uring *ring) {
+    __atomic_store_n(ring->sq_tail, *ring->sq_tail + 1, __ATOMIC_RELEASE);
+}
+
+i32 uring_read(
+    struct uring *ring,
+    i32 fd,
+    char *bytes,
+    u32 len,
+    u64 user_data
+) {
+    struct io_uring_sqe *sqe = uring_sqe(ring, IORING_OP_READ, fd, user_data);
+    if (sqe == 0) {
+        return -EBUSY;
+    }
+    sqe->addr = (u64)bytes;
+    sqe->len = len;
+    sqe->off = (u64)-1L;
+    uring_push(ring);
+    return 0;
+}
+
+i32 uring_poll(struct uring *ring, i32 fd, u32 events, u64 user_data) {
+    struct io_uring_sqe *sqe = uring_sqe(
+        ring,
+        IORING_OP_POLL_ADD,
+        fd,
+        user_data
+    );
+    if (sqe == 0) {
+        return -EBUSY;
+    }
+    sqe->op_flags = events;
+    uring_push(ring);
+    return 0;
+}
+
+i32 uring_timeout(struct uring *ring, struct timespec *when, u64 user_data) {
+    struct io_uring_sqe *sqe = uring_sqe(
+        ring,
+        IORING_OP_TIMEOUT,
+        -1,
+        user_data
+    );
+    if (sqe == 0) {
+        return -EBUSY;
+    }
+    sqe->addr = (u64)when;
+    sqe->len = 1;
+    sqe->op_flags = IORING_TIMEOUT_ABS;
+    uring_push(ring);
+    return 0;
+}
+
+i32 uring_timeout_remove(struct uring *ring, u64 target, u64 user_data) {
+    struct io_uring_sqe *sqe = uring_sqe(
+        ring,
+        IORING_OP_TIMEOUT_REMOVE,
+        -1,
+        user_data
+    );
+    if (sqe == 0) {
+        return -EBUSY;
+    }
+    sqe->addr = target;
+    uring_push(ring);
+    return 0;
+}
+
+i32 uring_submit(struct uring *ring, u32 min_complete) {
+    u32 head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    u32 to_submit = *ring->sq_tail - head;
+    u32 cq_head = *ring->cq_head;
+    u32 cq_tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    if (cq_tail != cq_head) {
+        min_complete = 0;
+    }
+    if (to_submit == 0 && min_complete == 0) {
+        return 0;
+    }
+
+    i32 result = io_uring_enter(
+        ring->fd,
+        to_submit,
+        min_complete,
+        (min_complete > 0) ? IORING_ENTER_GETEVENTS : 0
+    );
+    if (result == -EINTR || result == -EAGAIN || result == -EBUSY) {
+        return 0;
+    }
+    return (result < 0) ? result : 0;
+}
+
+i32 uring_harvest(
+    struct uring *ring,
+    struct uring_completion *completions,
+    i32 completions_len
+) {
+    u32 head = *ring->cq_head;
+    u32 tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    i32 len = 0;
+    while (head != tail && len < completions_len) {
+        struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+        completions[len].user_data = cqe->user_data;
+        completions[len].res = cqe->res;
+        len += 1;
+        head += 1;
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    return len;
+}